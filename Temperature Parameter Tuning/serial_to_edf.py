@@ -8,7 +8,7 @@ import os
 
 class EDFWriter:
     def __init__(self, port, baudrate=115200, output_dir="Temperature Parameter Tuning"):
-        self.serial = serial.Serial(port, baudrate)
+        self.serial = serial.Serial(port, baudrate) if port else None  # None for offline decoding
         self.output_dir = output_dir
         self.session_id = str(uuid.uuid4())
         self.group_id = str(uuid.uuid4())
@@ -65,7 +65,7 @@ Epoch_UTC\tLocal_Date_Time\tMassConc_1p0_SEN66_green_{self.sensor_id}\tMassConc_
     def parse_serial_line(self, line):
         # Split the line into values
         values = line.strip().split('\t')
-        if len(values) != 13:  # Expected number of values
+        if len(values) not in (13, 14, 19):  # Expected number of values, newer firmware adds raw CO2 and number concentrations
             return None
             
         # Convert values to appropriate types
@@ -83,14 +83,17 @@ Epoch_UTC\tLocal_Date_Time\tMassConc_1p0_SEN66_green_{self.sensor_id}\tMassConc_
             raw_temperature = float(values[10]) * 200  # Convert to raw value
             raw_voc = float(values[11])
             raw_nox = float(values[12])
-            raw_co2 = float(values[8])  # Same as CO2 for raw value
+            raw_co2 = float(values[13]) if len(values) >= 14 else float(values[8])  # Same as CO2 if not sent
             
-            # Calculate number concentrations (using same values as mass concentrations for simplicity)
-            numb_conc_0p5 = pm1p0 * 7  # Approximate conversion
-            numb_conc_1p0 = pm1p0 * 9
-            numb_conc_2p5 = pm2p5 * 6.8
-            numb_conc_4p0 = pm4p0 * 6.8
-            numb_conc_10p = pm10p0 * 6.8
+            if len(values) == 19:
+                numb_conc_0p5, numb_conc_1p0, numb_conc_2p5, numb_conc_4p0, numb_conc_10p = map(float, values[14:19])
+            else:
+                # Older firmware sends no number concentrations, approximate them from the mass concentrations
+                numb_conc_0p5 = pm1p0 * 7  # Approximate conversion
+                numb_conc_1p0 = pm1p0 * 9
+                numb_conc_2p5 = pm2p5 * 6.8
+                numb_conc_4p0 = pm4p0 * 6.8
+                numb_conc_10p = pm10p0 * 6.8
             
             return {
                 'pm1p0': pm1p0,
@@ -0,0 +1,205 @@
+"""Decode the firmware's binary telemetry ("mode bin") into the EDF format of serial_to_edf.py.
+
+Frames are COBS encoded and 0x00 terminated. A decoded frame is the payload followed by a
+little endian CRC-16/CCITT-FALSE of the payload. Every payload starts with the protocol
+version and a record type, see include/telemetry_protocol.h.
+
+Usage:
+    python telemetry_to_edf.py --port COM3                 record live samples to EDF
+    python telemetry_to_edf.py --port COM3 --dump out.csv  dump the flash history to CSV
+    python telemetry_to_edf.py --input capture.bin         decode a raw capture offline
+    python telemetry_to_edf.py --port COM3 --sensor 1      record the second sensor of a multi-sensor build
+"""
+import argparse
+import struct
+import time
+from datetime import datetime
+
+from serial_to_edf import EDFWriter
+
+PROTOCOL_VERSION = 4
+RECORD_SAMPLE = 1
+RECORD_HISTORY = 2
+RECORD_DUMP_END = 3
+
+SAMPLE_FORMAT = "<BBIIHHHHhhhhHhhHHHHHHHHB" # TelemetrySample
+HISTORY_FORMAT = "<BBIBBH9hHHH"             # TelemetryHeader + HistoryRecord
+DUMP_END_FORMAT = "<BBI"
+HISTORY_LEVEL_SECONDS = [1, 4, 24, 144, 576, 2880, 17280]  # Seconds per point of each pyramid level
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame) + 1:
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+class FrameDecoder:
+    """Splits a byte stream into verified payloads and keeps transfer statistics."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.bytes_received = 0
+        self.frames_ok = 0
+        self.frames_bad = 0
+        self.samples = 0
+
+    def feed(self, data):
+        self.bytes_received += len(data)
+        self.buffer += data
+        while True:
+            end = self.buffer.find(b"\x00")
+            if end < 0:
+                return
+            frame = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if not frame:
+                continue
+            payload = self.decode(frame)
+            if payload is not None:
+                yield payload
+
+    def decode(self, frame):
+        raw = cobs_decode(frame)
+        if raw is None or len(raw) < 4:
+            self.frames_bad += 1  # Text output between frames ends up here as well
+            return None
+        payload, crc = raw[:-2], struct.unpack("<H", raw[-2:])[0]
+        if crc16_ccitt(payload) != crc or payload[0] != PROTOCOL_VERSION:
+            self.frames_bad += 1
+            return None
+        self.frames_ok += 1
+        return payload
+
+    def report(self):
+        per_sample = self.bytes_received / self.samples if self.samples else 0.0
+        return (f"{self.samples} samples, {self.bytes_received} bytes, {per_sample:.1f} bytes/sample, "
+                f"{self.frames_ok} frames ok, {self.frames_bad} rejected")
+
+
+def sample_to_edf(payload):
+    (_, _, _timestamp, _ticks, pm1, pm25, pm4, pm10, rh, t, voc, nox, co2,
+     raw_rh, raw_t, raw_voc, raw_nox, raw_co2,
+     nc05, nc1, nc25, nc4, nc10, _sensor) = struct.unpack(SAMPLE_FORMAT, payload)
+    return {
+        'pm1p0': pm1 / 10.0,
+        'pm2p5': pm25 / 10.0,
+        'pm4p0': pm4 / 10.0,
+        'pm10p0': pm10 / 10.0,
+        'humidity': rh / 100.0,
+        'temperature': t / 200.0,
+        'voc_index': voc / 10.0,
+        'nox_index': nox / 10.0,
+        'co2': float(co2),
+        'numb_conc_0p5': nc05 / 10.0,
+        'numb_conc_1p0': nc1 / 10.0,
+        'numb_conc_2p5': nc25 / 10.0,
+        'numb_conc_4p0': nc4 / 10.0,
+        'numb_conc_10p': nc10 / 10.0,
+        'raw_humidity': float(raw_rh),
+        'raw_temperature': float(raw_t),
+        'raw_voc': float(raw_voc),
+        'raw_nox': float(raw_nox),
+        'raw_co2': float(raw_co2),
+    }
+
+
+def history_to_csv(payload):
+    fields = struct.unpack(HISTORY_FORMAT, payload)
+    sequence, level, _, mask = fields[2], fields[3], fields[4], fields[5]
+    values = fields[6:15]
+    boot, gaps = fields[15], fields[16]
+    columns = [str(v) if mask & (1 << i) and v != 0x7FFF else "" for i, v in enumerate(values)]
+    seconds = HISTORY_LEVEL_SECONDS[level] if level < len(HISTORY_LEVEL_SECONDS) else ""
+    return f"{level},{seconds},{sequence},{boot},{gaps}," + ",".join(columns) + "\n"
+
+
+def record_edf(decoder, source, writer, output, sensor):
+    output.write(writer.generate_header())
+    for payload in source:
+        if payload[1] == RECORD_SAMPLE and payload[-1] == sensor:
+            decoder.samples += 1
+            output.write(writer.write_data_line(sample_to_edf(payload), time.time()))
+            output.flush()
+            if decoder.samples % 60 == 0:
+                print(decoder.report())
+
+
+def dump_history(decoder, source, output):
+    output.write("level,seconds,sequence,boot,gaps_before,pm1,pm2p5,pm4,pm10,co2,voc,nox,temperature,humidity\n")
+    count = 0
+    for payload in source:
+        if payload[1] == RECORD_HISTORY:
+            output.write(history_to_csv(payload))
+            count += 1
+        elif payload[1] == RECORD_DUMP_END:
+            expected = struct.unpack(DUMP_END_FORMAT, payload)[2]
+            print(f"Dumped {count} of {expected} history records")
+            return
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", help="serial port of the monitor")
+    parser.add_argument("--input", help="raw binary capture to decode instead of a serial port")
+    parser.add_argument("--dump", metavar="CSV", help="request the flash history and write it to CSV")
+    parser.add_argument("--output-dir", default="Temperature Parameter Tuning")
+    parser.add_argument("--sensor", type=int, default=0, help="sensor ID to record on multi-sensor builds")
+    args = parser.parse_args()
+    if not args.port and not args.input:
+        parser.error("--port or --input is required")
+
+    writer = EDFWriter(port=None if args.input else args.port, output_dir=args.output_dir)
+    decoder = FrameDecoder()
+
+    if args.input:
+        with open(args.input, "rb") as capture:
+            chunks = iter(lambda: capture.read(4096), b"")
+            source = (payload for chunk in chunks for payload in decoder.feed(chunk))
+            filename = f"{args.output_dir}/{datetime.now():%Y-%m-%d_%H-%M-%S}-SEN66_green_{writer.sensor_id}.edf"
+            with open(filename, "w") as output:
+                record_edf(decoder, source, writer, output, args.sensor)
+        print(decoder.report())
+        return
+
+    port = writer.serial
+    port.timeout = 0.2
+    port.write(b"mode bin\n")
+    chunks = iter(lambda: port.read(port.in_waiting or 1), None)
+    source = (payload for chunk in chunks for payload in decoder.feed(chunk))
+    try:
+        if args.dump:
+            port.write(b"dump\n")
+            with open(args.dump, "w") as output:
+                dump_history(decoder, source, output)
+        else:
+            filename = f"{args.output_dir}/{datetime.now():%Y-%m-%d_%H-%M-%S}-SEN66_green_{writer.sensor_id}.edf"
+            print(f"Recording data to {filename}, press Ctrl+C to stop")
+            with open(filename, "w") as output:
+                record_edf(decoder, source, writer, output, args.sensor)
+    except KeyboardInterrupt:
+        print("\nRecording stopped")
+    finally:
+        print(decoder.report())
+        port.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), shared by flash records and telemetry frames
+ * @param data Bytes to checksum
+ * @param length Number of bytes
+ * @param crc Running value, pass the previous result to checksum data in pieces
+ * @return The CRC value
+ */
+inline uint16_t crc16_ccitt(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF) {
+    for (size_t i = 0; i < length; i++) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief CRC-8 of Sensirion sensors (poly 0x31, init 0xFF), protects every 16 bit word on the bus
+ * @param data Bytes to checksum, two for a sensor word
+ * @param length Number of bytes
+ * @return The CRC value
+ */
+inline uint8_t crc8_sensirion(const uint8_t* data, size_t length) {
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+        }
+    }
+    return crc;
+}
@@ -8,10 +8,44 @@
 // uncomment to enable serial logging
 #define SERIAL_LOGGING
 
+// uncomment to flush the display through the ESP32-S3 i80 LCD peripheral with DMA
+// and two draw buffers instead of the synchronous TFT_eSPI backend
+// #define DISPLAY_BACKEND_I80_DMA
+
 // I2C Configuration
 #define SENSOR_I2C_ADDRESS 0x6B
+#ifndef SENSOR_COUNT
+#define SENSOR_COUNT 1                      // Build with -D SENSOR_COUNT=2 to read a second SEN66 on Wire1
+#endif
+#define SENSOR_CHART_AVERAGE 0xFF
+#ifndef SENSOR_CHART_SOURCE
+#define SENSOR_CHART_SOURCE SENSOR_CHART_AVERAGE  // Sensor ID shown on the screens and charts, or the average of all sensors
+#endif
 #define SENSOR_READY_CHECK_INTERVAL 1000    // ms
-#define SENSOR_READY_RECHECK_TIME 100       // ms
+#define SENSOR_READY_RECHECK_TIME 100       // ms, re-poll interval while the data-ready phase is unknown
+#define SENSOR_READY_LEAD_TIME 15           // ms, wake this long before the predicted data-ready time
+#define SENSOR_LATE_RECHECK_TIME 10         // ms, re-poll interval when a predicted sample is late
+#define SENSOR_LATE_TOLERANCE 10            // ms past the predicted data-ready time plus the mean jitter before a poll counts as late
+#define SENSOR_PERIOD_SMOOTHING 8           // EMA divisor for the learned sample period
+#define SENSOR_STATS_REPORT_SAMPLES 60      // samples between acquisition statistics reports
+#define SENSOR_FAN_CLEANING_TIME 10000      // ms, fan runs at full speed before measuring again
+#define SENSOR_SHT_HEATER_TIME 1300         // ms, heater pulse duration
+#define SENSOR_WARMUP_SAMPLES 60            // samples after a measurement (re)start that are flagged as warming up
+#define SENSOR_STATUS_CHECK_SAMPLES 60      // samples between device status reads
+#define SENSOR_REINIT_ERRORS 10             // consecutive bus errors before the sensor is re-initialized
+#define SENSOR_RETRY_MIN_TIME 1000          // ms, first wait after a failed sensor initialization
+#define SENSOR_RETRY_MAX_TIME 60000         // ms, the wait doubles up to this
+#define VOC_STATE_READ_INTERVAL 600         // s, VOC algorithm state is read into the RAM checkpoint this often
+#define VOC_STATE_SAVE_INTERVAL 600         // s, minimum time between checkpoint writes to NVS, at most VOC_STATE_MAX_OFF_TIME
+#define VOC_STATE_MIN_LEARNING 3600         // s, a state that learned for less than this never replaces a saved one
+#define VOC_STATE_MAX_AGE 86400             // s, older checkpoints are discarded after a reset
+#define VOC_STATE_MAX_OFF_TIME 600          // s, longest interruption after which the SEN66 VOC state may be restored
+
+// SensorData::quality bits
+#define SAMPLE_QUALITY_RESTART      (1u << 0)  // First sample after the measurement started or restarted
+#define SAMPLE_QUALITY_WARMING_UP   (1u << 1)  // Gas channels are not settled yet
+#define SAMPLE_QUALITY_OUT_OF_RANGE (1u << 2)  // A value is outside its valid range or reported unknown
+#define SAMPLE_QUALITY_SENSOR_ERROR (1u << 3)  // The device status reports an error
 
 
 //STAR Engine Parameters:
@@ -30,6 +64,8 @@
 // Preferences namespace and key
 #define PREF_NAMESPACE              "sensor_config"
 #define PREF_ALTITUDE_KEY           "altitude"
+#define PREF_VOC_STATE_KEY          "voc_state"     // Followed by the sensor ID
+#define PREF_VOC_BOOT_KEY           "voc_boot"      // Boot counter the VOC checkpoints are stamped with
 
 /*ESP32S3*/
 #define PIN_LCD_BL                   38
@@ -58,6 +94,9 @@
 #define PIN_IIC_SCL                  17
 #define PIN_IIC_SDA                  18
 
+#define PIN_IIC1_SCL                 44     // Second sensor on Wire1, the board's Qwiic connector
+#define PIN_IIC1_SDA                 43
+
 #define PIN_TOUCH_INT                16
 #define PIN_TOUCH_RES                21
 
@@ -97,6 +136,31 @@ struct SensorData {
     uint16_t rawVOC;         ///< Raw VOC ticks without scale factor
     uint16_t rawNOx;         ///< Raw NOx ticks without scale factor
     uint16_t rawCO2;         ///< Not interpolated CO₂ concentration [ppm]
+
+    // Particle number concentrations, read every SEN66_NUMBER_CONC_INTERVAL samples and held in between
+    uint16_t numberConc0p5;  ///< Particles 0.3-0.5 µm per cm³ × 10, 0xFFFF if unknown
+    uint16_t numberConc1p0;  ///< Particles 0.3-1.0 µm per cm³ × 10, 0xFFFF if unknown
+    uint16_t numberConc2p5;  ///< Particles 0.3-2.5 µm per cm³ × 10, 0xFFFF if unknown
+    uint16_t numberConc4p0;  ///< Particles 0.3-4.0 µm per cm³ × 10, 0xFFFF if unknown
+    uint16_t numberConc10p0; ///< Particles 0.3-10 µm per cm³ × 10, 0xFFFF if unknown
+
+    // Measured values in the sensor's integer scaling, the floats above are derived from them.
+    // The chart history is built from these without any float arithmetic.
+    int32_t scaledPm1p0;        ///< PM1.0 × 10, 0xFFFF if unknown
+    int32_t scaledPm2p5;        ///< PM2.5 × 10, 0xFFFF if unknown
+    int32_t scaledPm4p0;        ///< PM4.0 × 10, 0xFFFF if unknown
+    int32_t scaledPm10p0;       ///< PM10.0 × 10, 0xFFFF if unknown
+    int32_t scaledHumidity;     ///< RH × 100, 0x7FFF if unknown
+    int32_t scaledTemperature;  ///< T × 200, 0x7FFF if unknown
+    int32_t scaledVocIndex;     ///< VOC index × 10, 0x7FFF if unknown
+    int32_t scaledNoxIndex;     ///< NOx index × 10, 0x7FFF if unknown
+    int32_t scaledCo2;          ///< CO2 in ppm, 0xFFFF if unknown
+
+    // Sample quality, assessed once by the I2C task so consumers don't repeat the checks
+    uint8_t quality;            ///< SAMPLE_QUALITY_* bits
+    uint16_t unusableChannels;  ///< Bit n set: the value of ParameterChannel n must not be charted or averaged
+
+    uint8_t sensorId;        ///< Sensor the sample came from, 0 to SENSOR_COUNT - 1
     uint32_t runtime_ticks;  // Runtime in ticks since start
 };
 
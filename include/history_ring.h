@@ -0,0 +1,124 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+/**
+ * @struct HistoryRing
+ * @brief Circular buffer holding the chart points of one history level
+ *
+ * Points are never moved: a new point overwrites the oldest one at head, and the
+ * chart is told to start drawing at head via lv_chart_set_x_start_point.
+ *
+ * The running minimum and maximum of the window are tracked with two monotonic
+ * deques of point indices, so autoscaling never has to rescan the points.
+ *
+ * @tparam Point Chart point type (lv_coord_t)
+ * @tparam Size Points in the window, one chart width
+ * @tparam None Gap marker (LV_CHART_POINT_NONE), never part of the minimum or maximum
+ */
+template <typename Point, size_t Size, Point None>
+struct HistoryRing {
+    using Slot = typename std::conditional<(Size <= 256), uint8_t, uint16_t>::type;
+
+    Point points[Size];      // Mean of the samples behind each point
+    Point min_points[Size];  // Smallest sample behind each point
+    Point max_points[Size];  // Largest sample behind each point
+    uint16_t head = 0;       // Next write position, which is also the oldest point
+
+    Slot min_slots[Size];    // Indices with increasing min_points, front is the minimum
+    uint16_t min_front = 0;
+    uint16_t min_count = 0;
+    Slot max_slots[Size];    // Indices with decreasing max_points, front is the maximum
+    uint16_t max_front = 0;
+    uint16_t max_count = 0;
+
+    /**
+     * @brief Fill the window with gaps
+     */
+    void clear() {
+        for (size_t i = 0; i < Size; i++) {
+            points[i] = None;
+            min_points[i] = None;
+            max_points[i] = None;
+        }
+        head = 0;
+        min_front = 0;
+        min_count = 0;
+        max_front = 0;
+        max_count = 0;
+    }
+
+    /**
+     * @brief Append a point in O(1)
+     * @param point The mean of the point (None for a gap)
+     * @param min_point The smallest sample behind the point
+     * @param max_point The largest sample behind the point
+     */
+    void push(Point point, Point min_point, Point max_point) {
+        const uint16_t slot = head;
+
+        // The point at head leaves the window. If it is still the minimum or maximum,
+        // it sits at the front of its deque, as the deques are ordered by age.
+        if (min_count > 0 && min_slots[min_front] == slot) {
+            min_front = (min_front + 1) % Size;
+            min_count--;
+        }
+        if (max_count > 0 && max_slots[max_front] == slot) {
+            max_front = (max_front + 1) % Size;
+            max_count--;
+        }
+
+        // Overwrite the oldest point and advance head, no data is moved
+        points[slot] = point;
+        min_points[slot] = point == None ? None : min_point;
+        max_points[slot] = point == None ? None : max_point;
+        head++;
+        if (head == Size) {
+            head = 0;
+        }
+
+        // Gaps never become the minimum or maximum
+        if (point == None) {
+            return;
+        }
+
+        // Drop points from the back that can no longer be the minimum/maximum of any window
+        // containing the new point. Each point is pushed and popped once: amortized O(1).
+        while (min_count > 0 && min_points[min_slots[(min_front + min_count - 1) % Size]] >= min_point) {
+            min_count--;
+        }
+        min_slots[(min_front + min_count) % Size] = static_cast<Slot>(slot);
+        min_count++;
+
+        while (max_count > 0 && max_points[max_slots[(max_front + max_count - 1) % Size]] <= max_point) {
+            max_count--;
+        }
+        max_slots[(max_front + max_count) % Size] = static_cast<Slot>(slot);
+        max_count++;
+    }
+
+    /**
+     * @brief Get the minimum and maximum of the window in O(1)
+     * @param min_point Receives the smallest sample in the window
+     * @param max_point Receives the largest sample in the window
+     * @return false if the window holds no valid point
+     */
+    bool range(Point& min_point, Point& max_point) const {
+        if (min_count == 0) {
+            return false;
+        }
+        min_point = min_points[min_slots[min_front]];
+        max_point = max_points[max_slots[max_front]];
+        return true;
+    }
+
+    /**
+     * @brief Get the most recently added point
+     * @return The newest point, None if it is a gap or the window is empty
+     */
+    Point last() const {
+        return points[(head + Size - 1) % Size];
+    }
+};
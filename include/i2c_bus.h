@@ -0,0 +1,76 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// Configuration
+#define I2C_BUS_MAX_CLOCK          400000   // Hz, first clock tried after every begin
+#define I2C_BUS_MIN_CLOCK          50000    // Hz, the clock is halved down to this on repeated errors
+#define I2C_BUS_STEP_DOWN_ERRORS   3        // Consecutive errors before the clock is lowered
+#define I2C_BUS_STEP_UP_SUCCESSES  3600     // Consecutive successes before a higher clock is tried again
+#define I2C_BUS_RECOVERY_PULSES    9        // SCL pulses to release a slave holding SDA low
+#define I2C_BUS_HALF_PERIOD_US     5        // Half period of the recovery clock, 100 kHz
+
+// Bus health since begin
+struct I2CBusStats {
+    uint32_t errors;        // Failed transfers
+    uint32_t stepDowns;     // Clock reductions
+    uint32_t stepUps;       // Clock increases after a clean run
+    uint32_t recoveries;    // Bus recoveries
+};
+
+/**
+ * @class I2CBus
+ * @brief Owns one TwoWire bus: clock selection, error tracking and stuck bus recovery
+ *
+ * The bus starts at I2C_BUS_MAX_CLOCK. Drivers report the outcome of every transfer and
+ * the clock follows: I2C_BUS_STEP_DOWN_ERRORS errors in a row halve it, a long clean run
+ * doubles it again, so marginal wiring settles at the fastest clock it carries.
+ */
+class I2CBus {
+public:
+    /**
+     * @brief Create the manager of a bus
+     * @param wire The bus
+     * @param sda SDA pin
+     * @param scl SCL pin
+     */
+    I2CBus(TwoWire& wire, int sda, int scl) : _wire(wire), _sda(sda), _scl(scl) {}
+
+    /**
+     * @brief Release a stuck bus if needed and start it at the highest clock
+     * @return true if the bus driver started
+     */
+    bool begin();
+
+    /**
+     * @brief Free a slave that holds SDA low, then restart the bus driver at the current clock
+     * @return true if SDA is released
+     * @details Clocks SCL until the slave has shifted out the byte it was stuck in and
+     *          finishes with a STOP condition, see the I2C specification's bus clear.
+     */
+    bool recover();
+
+    // Report the outcome of a transfer, errors lower the clock, a clean run raises it again
+    void reportSuccess();
+    void reportError();
+
+    // Errors since the last successful transfer
+    uint32_t consecutiveErrors() const { return _consecutiveErrors; }
+
+    TwoWire& wire() { return _wire; }
+    uint32_t clock() const { return _clock; }
+    const I2CBusStats& stats() const { return _stats; }
+
+private:
+    TwoWire& _wire;
+    int _sda;
+    int _scl;
+    uint32_t _clock = I2C_BUS_MAX_CLOCK;
+    uint32_t _consecutiveErrors = 0;
+    uint32_t _consecutiveSuccesses = 0;
+    I2CBusStats _stats = {};
+
+    // Apply a new clock to the running driver
+    void setClock(uint32_t clock);
+};
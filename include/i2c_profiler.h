@@ -0,0 +1,90 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "definitions.h"
+
+// Configuration
+#define I2C_PROFILER_BUCKETS         16     // Latency buckets per command
+#define I2C_PROFILER_FIRST_BUCKET_US 32     // Upper bound of bucket 0, every further bucket doubles it
+
+// Sensor commands with their own profile
+enum class I2CCommand : uint8_t {
+    GetDataReady,
+    ReadMeasuredValues,
+    ReadRawValues,
+    ReadNumberConcentrations,
+    ReadDeviceStatus,
+    DeviceReset,
+    SetTemperatureAcceleration,
+    SetTemperatureOffset,
+    SetAltitude,
+    StartMeasurement,
+    StopMeasurement,
+    ForcedRecalibration,
+    FanCleaning,
+    ShtHeater,
+    GetSerialNumber,
+    GetVocAlgorithmState,
+    SetVocAlgorithmState
+};
+
+#define I2C_COMMAND_COUNT 17
+
+// Latency profile of one command, bucket n counts calls below I2C_PROFILER_FIRST_BUCKET_US << n
+struct I2CCommandProfile {
+    uint32_t count;
+    uint32_t errors;
+    uint32_t maxUs;
+    uint64_t totalUs;
+    uint32_t buckets[I2C_PROFILER_BUCKETS];     // The last bucket also holds everything slower
+};
+
+/**
+ * @brief Add one call to the profile of a command
+ * @param sensorId Sensor the command was sent to
+ * @param command The command
+ * @param us Time from the command write to the end of its response, execution time included
+ * @param error true if the call failed
+ */
+void i2c_profiler_record(uint8_t sensorId, I2CCommand command, uint32_t us, bool error);
+
+/**
+ * @brief Copy the profile of a command
+ * @param sensorId Sensor to report
+ * @param command The command
+ * @param profile Receives the profile
+ */
+void i2c_profiler_get(uint8_t sensorId, I2CCommand command, I2CCommandProfile* profile);
+
+// Clear the profiles of all sensors
+void i2c_profiler_reset();
+
+/**
+ * @brief Get the name of a command for reports
+ * @param command The command
+ * @return The command's name
+ */
+const char* i2c_command_name(I2CCommand command);
+
+/**
+ * @brief Upper latency bound of a histogram bucket
+ * @param bucket Bucket index
+ * @return Bound in us, UINT32_MAX for the last bucket
+ */
+uint32_t i2c_profiler_bucket_limit(uint8_t bucket);
+
+/**
+ * @brief Run a sensor driver call and record it under a command
+ * @param sensorId Sensor the call talks to
+ * @param command The command the call executes
+ * @param call Callable returning the driver's error code, 0 on success
+ * @return The call's error code
+ */
+template <typename Call>
+uint16_t i2c_profiled(uint8_t sensorId, I2CCommand command, Call call) {
+    int64_t start = esp_timer_get_time();
+    uint16_t error = call();
+    i2c_profiler_record(sensorId, command, static_cast<uint32_t>(esp_timer_get_time() - start), error != 0);
+    return error;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Plain C interface, lv_conf.h routes the LVGL heap through it
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Memory users with their own placement and accounting
+typedef enum {
+    MEMORY_REGION_LVGL = 0,     // LVGL object heap: screens, widgets, styles (PSRAM)
+    MEMORY_REGION_HISTORY,      // Chart history tiers and restore scratch buffers (PSRAM)
+    MEMORY_REGION_COUNT
+} memory_region_t;
+
+// Usage of one region
+typedef struct {
+    size_t used;                // Bytes currently allocated
+    size_t peak;                // Highest value of used
+    size_t external;            // Bytes of used that live in PSRAM
+    uint32_t allocations;       // Blocks currently allocated
+    uint32_t failures;          // Allocations that could not be served
+} memory_region_stats_t;
+
+/**
+ * @brief Allocate cold data in PSRAM, falling back to internal RAM if PSRAM is missing or full
+ * @param region Region the block is accounted to
+ * @param size Size in bytes
+ * @return The block, or NULL if no memory is left
+ */
+void* memory_alloc(memory_region_t region, size_t size);
+
+/**
+ * @brief Free a block allocated with memory_alloc or memory_realloc
+ * @param region Region the block was allocated from
+ * @param ptr The block, may be NULL
+ */
+void memory_free(memory_region_t region, void* ptr);
+
+/**
+ * @brief Resize a block, keeping it in PSRAM where possible
+ * @param region Region the block is accounted to
+ * @param ptr The block, may be NULL
+ * @param size New size in bytes
+ * @return The resized block, or NULL if no memory is left (ptr stays valid)
+ */
+void* memory_realloc(memory_region_t region, void* ptr, size_t size);
+
+/**
+ * @brief Get the usage of a region
+ * @param region Region to query
+ * @param stats Receives the usage
+ */
+void memory_region_get_stats(memory_region_t region, memory_region_stats_t* stats);
+
+/**
+ * @brief Get the name of a region for reports
+ * @param region Region to name
+ * @return The region's name
+ */
+const char* memory_region_name(memory_region_t region);
+
+// LVGL heap hooks, see LV_MEM_CUSTOM in lv_conf.h
+void* lvgl_mem_alloc(size_t size);
+void lvgl_mem_free(void* ptr);
+void* lvgl_mem_realloc(void* ptr, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "definitions.h"
+
+// Measured channels, in the value order of history records and telemetry
+enum class ParameterChannel : uint8_t {
+    PM1p0,
+    PM2p5,
+    PM4p0,
+    PM10p0,
+    CO2,
+    VOC,
+    NOx,
+    Temperature,
+    Humidity
+};
+
+#define PARAMETER_CHANNEL_COUNT 9
+
+// Bit of a channel in SensorData::unusableChannels and history channel masks
+constexpr uint16_t parameter_channel_bit(ParameterChannel channel) {
+    return static_cast<uint16_t>(1u << static_cast<uint8_t>(channel));
+}
+
+#define PARAMETER_ALL_CHANNELS ((1u << PARAMETER_CHANNEL_COUNT) - 1)
+
+// Channels whose values are not meaningful while the sensor warms up
+#define PARAMETER_WARMUP_CHANNELS (parameter_channel_bit(ParameterChannel::CO2) | \
+                                   parameter_channel_bit(ParameterChannel::VOC) | \
+                                   parameter_channel_bit(ParameterChannel::NOx))
+
+// Threshold colour of a value, shared by the tile indicators and the value labels
+enum class ColorBand : uint8_t {
+    Green,
+    Orange,
+    Red,
+    Blue
+};
+
+// One step of a colour table: values below limit (or equal to it if inclusive) get band
+struct ColorThreshold {
+    float limit;
+    bool inclusive;
+    ColorBand band;
+};
+
+#define PARAMETER_MAX_THRESHOLDS 4
+
+/**
+ * @struct ParameterDescriptor
+ * @brief Compile-time description of one measured channel
+ */
+struct ParameterDescriptor {
+    const char* name;
+    float SensorData::* field;      ///< Value in SensorData
+    uint8_t decimals;               ///< Decimals on the parameter screen and in chart points
+    float scale;                    ///< 10^decimals, float value to chart point
+    float inverseScale;             ///< 10^-decimals, chart point to float value
+    uint8_t tileDecimals;           ///< Decimals on the main screen tile
+    float integerAbove;             ///< Values at or above this drop their decimals, 0 = never
+    float sensorScale;              ///< SEN66 integer scaling used by the binary telemetry
+    int32_t SensorData::* sensorField;  ///< Value in the sensor's integer scaling
+    int32_t sensorMin;              ///< validMin..validMax in the sensor's integer scaling
+    int32_t sensorMax;
+    int32_t pointMultiplier;        ///< Sensor integer to chart point: value * pointMultiplier / pointDivisor
+    int32_t pointDivisor;
+    float validMin;                 ///< Values outside validMin..validMax are shown as unknown
+    float validMax;
+    float chartDefaultMin;          ///< Chart range while there is no data
+    float chartDefaultMax;
+    float chartMinSpread;           ///< Smallest chart range
+    bool chartAllowsNegative;       ///< false: the chart range is clamped at 0
+    ColorThreshold thresholds[PARAMETER_MAX_THRESHOLDS];
+    uint8_t thresholdCount;
+    ColorBand aboveBand;            ///< Band of values above the last threshold
+};
+
+constexpr float parameter_pow10(uint8_t exponent) {
+    return exponent == 0 ? 1.0f : 10.0f * parameter_pow10(exponent - 1);
+}
+
+// Sensor integer scaling of a display unit limit
+constexpr int32_t parameter_sensor_limit(float limit, float sensorScale) {
+    return static_cast<int32_t>(limit * sensorScale);
+}
+
+// Chart points carry 10^decimals, the sensor integers sensorScale: one of the two factors is 1
+constexpr int32_t parameter_point_multiplier(uint8_t decimals, float sensorScale) {
+    return parameter_pow10(decimals) > sensorScale ? static_cast<int32_t>(parameter_pow10(decimals) / sensorScale) : 1;
+}
+
+constexpr int32_t parameter_point_divisor(uint8_t decimals, float sensorScale) {
+    return sensorScale > parameter_pow10(decimals) ? static_cast<int32_t>(sensorScale / parameter_pow10(decimals)) : 1;
+}
+
+// PM1.0, PM4.0 and PM10 share the PM2.5 thresholds and chart ranges
+#define PARAMETER_PM_DESCRIPTOR(label, member, scaledMember)                                \
+    {label, &SensorData::member, PM_DECIMALS, parameter_pow10(PM_DECIMALS),               \
+     1.0f / parameter_pow10(PM_DECIMALS), 1, 100.0f, 10.0f, &SensorData::scaledMember,    \
+     parameter_sensor_limit(SensorThresholds::PM25::MIN, 10.0f),                          \
+     parameter_sensor_limit(SensorThresholds::PM25::MAX, 10.0f),                          \
+     parameter_point_multiplier(PM_DECIMALS, 10.0f), parameter_point_divisor(PM_DECIMALS, 10.0f), \
+     SensorThresholds::PM25::MIN, SensorThresholds::PM25::MAX,                            \
+     ChartRanges::PM::DEFAULT_MIN, ChartRanges::PM::DEFAULT_MAX, ChartRanges::PM::MIN_SPREAD, false, \
+     {{SensorThresholds::PM25::GREEN_MAX, false, ColorBand::Green},                       \
+      {SensorThresholds::PM25::ORANGE_MAX, true, ColorBand::Orange}},                     \
+     2, ColorBand::Red}
+
+static constexpr ParameterDescriptor kParameterDescriptors[PARAMETER_CHANNEL_COUNT] = {
+    PARAMETER_PM_DESCRIPTOR("PM1.0", pm1p0, scaledPm1p0),
+    PARAMETER_PM_DESCRIPTOR("PM2.5", pm2p5, scaledPm2p5),
+    PARAMETER_PM_DESCRIPTOR("PM4.0", pm4p0, scaledPm4p0),
+    PARAMETER_PM_DESCRIPTOR("PM10.0", pm10p0, scaledPm10p0),
+    {"CO2", &SensorData::co2, CO2_DECIMALS, parameter_pow10(CO2_DECIMALS),
+     1.0f / parameter_pow10(CO2_DECIMALS), 0, 0.0f, 1.0f, &SensorData::scaledCo2,
+     parameter_sensor_limit(SensorThresholds::CO2::MIN, 1.0f), parameter_sensor_limit(SensorThresholds::CO2::MAX, 1.0f),
+     parameter_point_multiplier(CO2_DECIMALS, 1.0f), parameter_point_divisor(CO2_DECIMALS, 1.0f),
+     SensorThresholds::CO2::MIN, SensorThresholds::CO2::MAX,
+     ChartRanges::CO2::DEFAULT_MIN, ChartRanges::CO2::DEFAULT_MAX, ChartRanges::CO2::MIN_SPREAD, false,
+     {{SensorThresholds::CO2::BLUE_MAX, false, ColorBand::Blue},
+      {SensorThresholds::CO2::GREEN_MAX, false, ColorBand::Green},
+      {SensorThresholds::CO2::ORANGE_MAX, true, ColorBand::Orange}},
+     3, ColorBand::Red},
+    {"VOC", &SensorData::vocIndex, VOC_DECIMALS, parameter_pow10(VOC_DECIMALS),
+     1.0f / parameter_pow10(VOC_DECIMALS), 0, 0.0f, 10.0f, &SensorData::scaledVocIndex,
+     parameter_sensor_limit(SensorThresholds::VOC::MIN, 10.0f), parameter_sensor_limit(SensorThresholds::VOC::MAX, 10.0f),
+     parameter_point_multiplier(VOC_DECIMALS, 10.0f), parameter_point_divisor(VOC_DECIMALS, 10.0f),
+     SensorThresholds::VOC::MIN, SensorThresholds::VOC::MAX,
+     ChartRanges::VOC::DEFAULT_MIN, ChartRanges::VOC::DEFAULT_MAX, ChartRanges::VOC::MIN_SPREAD, false,
+     {{SensorThresholds::VOC::BLUE_MAX, false, ColorBand::Blue},
+      {SensorThresholds::VOC::GREEN_MAX, true, ColorBand::Green},
+      {SensorThresholds::VOC::ORANGE_MAX, true, ColorBand::Orange}},
+     3, ColorBand::Red},
+    {"NOx", &SensorData::noxIndex, NOX_DECIMALS, parameter_pow10(NOX_DECIMALS),
+     1.0f / parameter_pow10(NOX_DECIMALS), 0, 0.0f, 10.0f, &SensorData::scaledNoxIndex,
+     parameter_sensor_limit(SensorThresholds::NOx::MIN, 10.0f), parameter_sensor_limit(SensorThresholds::NOx::MAX, 10.0f),
+     parameter_point_multiplier(NOX_DECIMALS, 10.0f), parameter_point_divisor(NOX_DECIMALS, 10.0f),
+     SensorThresholds::NOx::MIN, SensorThresholds::NOx::MAX,
+     ChartRanges::NOx::DEFAULT_MIN, ChartRanges::NOx::DEFAULT_MAX, ChartRanges::NOx::MIN_SPREAD, false,
+     {{SensorThresholds::NOx::GREEN_MAX, true, ColorBand::Green},
+      {SensorThresholds::NOx::ORANGE_MAX, true, ColorBand::Orange}},
+     2, ColorBand::Red},
+    {"T", &SensorData::temperature, TEMP_DECIMALS, parameter_pow10(TEMP_DECIMALS),
+     1.0f / parameter_pow10(TEMP_DECIMALS), 1, 0.0f, 200.0f, &SensorData::scaledTemperature,
+     parameter_sensor_limit(SensorThresholds::Temperature::MIN, 200.0f), parameter_sensor_limit(SensorThresholds::Temperature::MAX, 200.0f),
+     parameter_point_multiplier(TEMP_DECIMALS, 200.0f), parameter_point_divisor(TEMP_DECIMALS, 200.0f),
+     SensorThresholds::Temperature::MIN, SensorThresholds::Temperature::MAX,
+     ChartRanges::Temperature::DEFAULT_MIN, ChartRanges::Temperature::DEFAULT_MAX, ChartRanges::Temperature::MIN_SPREAD, true,
+     {{SensorThresholds::Temperature::BLUE_MAX, false, ColorBand::Blue},
+      {SensorThresholds::Temperature::GREEN_MAX, true, ColorBand::Green}},
+     2, ColorBand::Red},
+    // Humidity is green in the middle band and gets worse in both directions
+    {"RH", &SensorData::humidity, RH_DECIMALS, parameter_pow10(RH_DECIMALS),
+     1.0f / parameter_pow10(RH_DECIMALS), 1, 0.0f, 100.0f, &SensorData::scaledHumidity,
+     parameter_sensor_limit(SensorThresholds::Humidity::MIN, 100.0f), parameter_sensor_limit(SensorThresholds::Humidity::MAX, 100.0f),
+     parameter_point_multiplier(RH_DECIMALS, 100.0f), parameter_point_divisor(RH_DECIMALS, 100.0f),
+     SensorThresholds::Humidity::MIN, SensorThresholds::Humidity::MAX,
+     ChartRanges::Humidity::DEFAULT_MIN, ChartRanges::Humidity::DEFAULT_MAX, ChartRanges::Humidity::MIN_SPREAD, false,
+     {{SensorThresholds::Humidity::ORANGE_MIN, false, ColorBand::Red},
+      {SensorThresholds::Humidity::GREEN_MIN, false, ColorBand::Orange},
+      {SensorThresholds::Humidity::GREEN_MAX, true, ColorBand::Green},
+      {SensorThresholds::Humidity::ORANGE_MAX, true, ColorBand::Orange}},
+     4, ColorBand::Red}
+};
+
+#undef PARAMETER_PM_DESCRIPTOR
+
+/**
+ * @brief Get the descriptor of a channel
+ * @param channel The channel
+ * @return The channel's descriptor
+ */
+constexpr const ParameterDescriptor& parameter_descriptor(ParameterChannel channel) {
+    return kParameterDescriptors[static_cast<size_t>(channel)];
+}
+
+/**
+ * @brief Check a value against the channel's valid range
+ * @param descriptor The channel's descriptor
+ * @param value The value in display units
+ * @return true if the value can be shown
+ */
+inline bool parameter_is_valid(const ParameterDescriptor& descriptor, float value) {
+    return value >= descriptor.validMin && value <= descriptor.validMax;
+}
+
+/**
+ * @brief Check a sensor integer against the channel's valid range
+ * @param descriptor The channel's descriptor
+ * @param value The value in the sensor's integer scaling, unknown markers fail the check
+ * @return true if the value can be shown
+ */
+inline bool parameter_sensor_is_valid(const ParameterDescriptor& descriptor, int32_t value) {
+    return value >= descriptor.sensorMin && value <= descriptor.sensorMax;
+}
+
+/**
+ * @brief Rescale a sensor integer to a chart point, truncating toward zero like the former float path
+ * @param descriptor The channel's descriptor
+ * @param value The value in the sensor's integer scaling
+ * @return The value with the channel's decimal places, as stored in the chart history
+ */
+constexpr int32_t parameter_sensor_to_point(const ParameterDescriptor& descriptor, int32_t value) {
+    return value * descriptor.pointMultiplier / descriptor.pointDivisor;
+}
+
+/**
+ * @brief Average sensor integers, rounded to nearest
+ * @param sum Sum of the values in the sensor's integer scaling
+ * @param count Number of values, at least 1
+ * @return The mean, halves rounded away from zero so negative values are not biased upward
+ */
+constexpr int32_t parameter_sensor_mean(int32_t sum, int32_t count) {
+    return (sum >= 0 ? sum + count / 2 : sum - count / 2) / count;
+}
+
+/**
+ * @brief Look up the colour band of a value
+ * @param descriptor The channel's descriptor
+ * @param value The value in display units
+ * @return The band of the first threshold the value falls below
+ */
+inline ColorBand parameter_color_band(const ParameterDescriptor& descriptor, float value) {
+    for (uint8_t i = 0; i < descriptor.thresholdCount; i++) {
+        const ColorThreshold& threshold = descriptor.thresholds[i];
+        if (value < threshold.limit || (threshold.inclusive && value == threshold.limit)) {
+            return threshold.band;
+        }
+    }
+    return descriptor.aboveBand;
+}
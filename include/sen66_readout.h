@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "definitions.h"
+#include "i2c_profiler.h"
+
+// Configuration
+#define SEN66_COMMAND_EXECUTION_TIME 20     // ms between a read command and its response
+#define SEN66_RAW_VALUES_INTERVAL    1      // Samples between raw value reads
+#define SEN66_NUMBER_CONC_INTERVAL   10     // Samples between number concentration reads
+#define SEN66_MAX_RESPONSE_WORDS     9      // Largest response, read measured values
+
+// Response groups, each read with one command on its own schedule
+enum class Sen66ReadGroup : uint8_t {
+    MeasuredValues,         // Mass concentrations, RH, T, VOC/NOx index, CO2, every sample
+    RawValues,              // Raw RH, T, VOC, NOx and CO2
+    NumberConcentrations    // Particle number concentrations
+};
+
+#define SEN66_READ_GROUP_COUNT 3
+
+// Bus traffic of the sample path
+struct Sen66BusCounters {
+    uint32_t transactions;  // Command writes and response reads
+    uint32_t bytes;         // Bytes on the wire including address bytes
+    uint64_t busUs;         // Time spent in bus transfers, without the command execution waits
+    uint32_t crcErrors;     // Responses rejected because a word failed its CRC
+    uint32_t groupReads[SEN66_READ_GROUP_COUNT];
+};
+
+/**
+ * @class Sen66Readout
+ * @brief Sample path of the SEN66, talking to the sensor without the driver's per-command helpers
+ *
+ * All groups due for a sample are read back-to-back in one bus session and every response
+ * is CRC-checked and decoded into SensorData in a single pass over its bytes. Commands
+ * outside the sample path (start/stop, calibration, ...) still go through SensirionI2cSen66.
+ */
+class Sen66Readout {
+public:
+    /**
+     * @brief Set the bus and address used for all reads
+     * @param wire I2C bus the sensor is attached to
+     * @param address 7 bit I2C address
+     * @param sensorId Sensor ID the commands are profiled under
+     */
+    void begin(TwoWire& wire, uint8_t address, uint8_t sensorId);
+
+    /**
+     * @brief Poll the data-ready flag
+     * @param ready Receives true if a new sample can be read
+     * @param counters Bus traffic is added here
+     * @return 0 on success, otherwise a Sensirion error code for errorToString
+     */
+    uint16_t readDataReady(bool& ready, Sen66BusCounters& counters);
+
+    /**
+     * @brief Read every group that is due for a sample
+     * @param sample Sample number since the measurement was started, 1 for the first: every group is read
+     * @param data Receives the decoded values, groups that are not due keep their previous values
+     * @param counters Bus traffic is added here
+     * @return 0 on success, otherwise the Sensirion error code of the first failed group
+     */
+    uint16_t readSample(uint32_t sample, SensorData& data, Sen66BusCounters& counters);
+
+private:
+    TwoWire* _wire = nullptr;
+    uint8_t _address = 0;
+    uint8_t _sensorId = 0;
+
+    /**
+     * @brief Send a read command, wait for it to execute and read its CRC-checked words
+     * @param command 16 bit command code
+     * @param profile Profiler entry the call is recorded under
+     * @param words Receives the response words
+     * @param count Number of words expected
+     * @param counters Bus traffic is added here
+     * @return 0 on success, otherwise a Sensirion error code
+     */
+    uint16_t readWords(uint16_t command, I2CCommand profile, uint16_t* words, uint8_t count, Sen66BusCounters& counters);
+
+    // The unprofiled transfer behind readWords
+    uint16_t transferWords(uint16_t command, uint16_t* words, uint8_t count, Sen66BusCounters& counters);
+};
@@ -24,6 +24,16 @@ private:
     Button2 buttonLeft;
     Button2 buttonRight;
 
+    // Button2 needs loop() calls while a press is being debounced and classified,
+    // keep polling this long after the last pin change before sleeping again
+    static constexpr uint32_t kActivePollIntervalMs = 5;
+    static constexpr uint32_t kActiveHoldMs = 200;
+
+    /**
+     * @brief Wakes the button task on any edge of either button pin
+     */
+    static void IRAM_ATTR buttonEdgeISR();
+
     // Button callback functions
     void handleLeftButton(Button2& btn);
     void handleRightButton(Button2& btn);
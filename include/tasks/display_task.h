@@ -5,8 +5,31 @@
 #include <ui/ui.h>
 #include <FreeRTOS.h>
 #include <task.h>
+#include <queue.h>
 #include <Preferences.h>
 #include "definitions.h"
+#include "parameter_descriptors.h"
+#include "history_ring.h"
+#include "tasks/history_store.h"
+#ifdef DISPLAY_BACKEND_I80_DMA
+#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_ops.h>
+#endif
+
+// Task notification bits handled by the display task (bit 0 is LIVE_DATA_NOTIFY_BIT)
+#define DISPLAY_INPUT_NOTIFY_BIT (1UL << 1)  // User input changed the UI, render now
+#define DISPLAY_SENSOR_RESULT_NOTIFY_BIT (1UL << 2)  // A sensor command result is queued
+
+struct SensorCommandResult;
+struct QueueMessage;
+
+// Button events, queued by the button task and handled on the display task
+enum class DisplayInput : uint8_t {
+    LeftPress,
+    RightPress,
+    LeftLongPress,
+    RightLongPress
+};
 
 /**
  * @class DisplayTask
@@ -33,11 +56,19 @@ public:
     // Task handle
     static TaskHandle_t xDisplayTaskHandle;
 
-    // Button handlers
-    void handleLeftButtonPress();
-    void handleRightButtonPress();
-    void handleLeftButtonLongPress();
-    void handleRightButtonLongPress();
+    /**
+     * @brief Wake the display task before its next LVGL deadline
+     * @param bits Notification bits to set
+     */
+    static void notify(uint32_t bits);
+
+    /**
+     * @brief Queue a button event for the display task and wake it
+     * @param input The button event
+     * @details LVGL and the chart history are only touched by the display task,
+     *          so the button task never runs the handlers itself.
+     */
+    static void postInput(DisplayInput input);
 
     /**
      * @brief Set the display brightness using PWM
@@ -45,6 +76,12 @@ public:
      */
     void setDisplayBrightness(uint8_t brightness);
 
+    /**
+     * @brief Get the number of completed display frames per second
+     * @return Frames flushed to the panel during the last measurement window
+     */
+    float getFramesPerSecond() const { return framesPerSecond; }
+
 private:
     // Private constructor for singleton
     DisplayTask();
@@ -62,6 +99,22 @@ private:
     static constexpr uint16_t kScreenWidth = 170;
     static constexpr uint16_t kScreenHeight = 320;
     static constexpr uint16_t kBufferSize = kScreenWidth * kScreenHeight / 10;  // Full screen buffer
+
+    // i80 LCD peripheral configuration (DISPLAY_BACKEND_I80_DMA)
+    static constexpr uint32_t kI80PixelClockHz = 10 * 1000 * 1000;  // 10MHz write clock
+    static constexpr size_t kI80TransferQueueDepth = 10;
+    static constexpr int kPanelColumnOffset = 35;                   // 170px panel sits in the middle of the ST7789 240px RAM
+
+    // Frame rate measurement
+    static constexpr uint32_t kFpsWindowMs = 1000;
+
+    // Longest sleep between LVGL runs when no timer is due
+    static constexpr uint32_t kMaxIdleWaitMs = 500;
+
+    // Sensor command results
+    static constexpr size_t kSensorResultQueueSize = 4;
+    static constexpr size_t kInputQueueSize = 8;
+    static constexpr uint32_t kFRCTimeoutMs = 5000;  // Give up waiting for an FRC result after this
     
     // LEDC PWM configuration
     static constexpr uint8_t kLEDCChannel = 0;        // LEDC channel 0
@@ -69,23 +122,18 @@ private:
     static constexpr uint32_t kLEDCFrequency = 5000;  // 5kHz PWM frequency
     
     // Ring buffer configuration
-    static constexpr size_t kRingBufferSize  = 150;         // Ring buffer Size
-    static constexpr size_t kMidTermBufferSize = 24;        // 24 seconds of data
-    static constexpr size_t kLongTermBufferSize = 24;      // 576 seconds of data by using kMidTermBufferSize combined with kLongTermBufferSize
-    
-    // Chart display modes
-    enum class ChartDisplayMode {
-        ShortTerm,    // 2.5 minutes of data
-        MidTerm,      // 60 minutes of data
-        LongTerm      // 24 hours of data
-    };
-    
-    ChartDisplayMode currentDisplayMode = ChartDisplayMode::ShortTerm;
+    static constexpr size_t kRingBufferSize  = 150;         // Points per history level, one chart width
+
+    // Displayed history level, the chart window is kRingBufferSize points of that level
+    uint8_t currentChartLevel = 0;
+
+    // Chart Time Screen checkboxes, one per history level
+    lv_obj_t* chart_window_checkboxes[HISTORY_LEVELS] = {};
 
     // Settings state storage
     int savedFRCTargetValue = 0;
     int savedAltitudeValue = 0;
-    ChartDisplayMode savedChartDisplayMode = ChartDisplayMode::ShortTerm;
+    uint8_t savedChartLevel = 0;
     bool savedBrightness100 = false;
     bool savedBrightness75 = false;
     bool savedBrightness50 = false;
@@ -94,34 +142,131 @@ private:
     String savedFRCTitle = "";
     String savedFRCUnit = "";
 
-    // Ring buffers for IAQ parameters
+    // Circular buffer of one history level with O(1) append and min/max
+    using HistoryTier = HistoryRing<lv_coord_t, kRingBufferSize, LV_CHART_POINT_NONE>;
+
+    // Points of one level collected for the next point of the level above
+    struct LevelAccumulator {
+        int32_t sum = 0;        // Sum of the level 0 samples behind the collected points
+        uint16_t samples = 0;   // Usable level 0 samples behind the collected points
+        lv_coord_t min = 0;
+        lv_coord_t max = 0;
+        uint8_t inputs = 0;     // Points collected, gaps included, so every level stays on the same clock
+    };
+
+    // Aggregate pyramid of one IAQ parameter: level 0 holds the samples, every
+    // level above holds min/mean/max of a fixed number of points of the level below
     struct ParameterBuffers {
-        // Short-term 
-        lv_coord_t short_term_ring_buffer[kRingBufferSize];
-        
-        // Mid-term 
-        lv_coord_t mid_term_ring_buffer[kRingBufferSize];
-        float mid_term_sum = 0.0f;
-        uint8_t mid_term_count = 0;
-        
-        // Long-term
-        lv_coord_t long_term_ring_buffer[kRingBufferSize];
-        float long_term_sum = 0.0f;
-        uint8_t long_term_count = 0;
+        HistoryTier levels[HISTORY_LEVELS];
+        LevelAccumulator accumulators[HISTORY_LEVELS - 1];  // accumulators[n] feeds level n + 1
     };
     
-    ParameterBuffers pm1_buffers;
-    ParameterBuffers pm2p5_buffers;
-    ParameterBuffers pm4_buffers;
-    ParameterBuffers pm10_buffers;
-    ParameterBuffers co2_buffers;
-    ParameterBuffers voc_buffers;
-    ParameterBuffers nox_buffers;
-    ParameterBuffers temp_buffers;
-    ParameterBuffers rh_buffers;
-    
-    // Helper functions for buffer management
-    void updateParameterBuffer(ParameterBuffers* buffers, float value);
+    // Indexed by ParameterChannel. Allocated in PSRAM by allocate_buffers, the levels are
+    // written once per sample and only the displayed one is read while rendering.
+    ParameterBuffers* parameter_buffers = nullptr;
+
+    // Level 0 point spacing, the sensor's measurement interval
+    static constexpr int64_t kHistorySlotUs = 1000000;
+
+    // History clock shared by all channels: level 0 slot n is the sample published
+    // closest to historyEpochUs + n * kHistorySlotUs
+    bool historyClockStarted = false;
+    int64_t historyEpochUs = 0;
+    uint32_t nextHistorySlot = 0;   // Slot the next level 0 point is written to
+    uint32_t lateSamples = 0;       // Samples whose level 1 bucket was already closed
+
+    // Points added to each level by one sample, the same for every channel
+    using LevelPoints = uint16_t[HISTORY_LEVELS];
+
+    /**
+     * @brief Add a sample to the pyramid of one channel
+     * @param channel The channel the sample belongs to
+     * @param data The sample, channels flagged unusable become a gap
+     * @param points Incremented for every point added to a level
+     */
+    void updateParameterBuffer(ParameterChannel channel, const SensorData& data, LevelPoints& points);
+
+    /**
+     * @brief Push a point into one level and carry completed aggregates up the pyramid
+     * @param buffers The parameter buffers to update
+     * @param level The level to push into
+     * @param sum Sum of the usable level 0 samples behind the point
+     * @param samples Number of those samples, 0 for a gap
+     * @param min_point The smallest sample behind the point
+     * @param max_point The largest sample behind the point
+     * @param points Incremented for every point added to a level
+     * @details Level n is only reached once per product of the ratios below it, so the
+     *          cost per sample is amortized O(1) whatever the number of levels.
+     */
+    void push_pyramid_point(ParameterBuffers* buffers, uint8_t level, int32_t sum, uint16_t samples,
+                            lv_coord_t min_point, lv_coord_t max_point, LevelPoints& points);
+
+    /**
+     * @brief Fill missed level 0 slots with gaps, keeping every level on the clock
+     * @param buffers The parameter buffers to update
+     * @param count Number of missed slots
+     * @param points Incremented for every point added to a level
+     * @details Bounded by kRingBufferSize pushes per level however long the outage was:
+     *          whole buckets of gaps are carried up arithmetically.
+     */
+    void push_pyramid_gaps(ParameterBuffers* buffers, uint32_t count, LevelPoints& points);
+
+    /**
+     * @brief Add a sample for an already written slot to the open level 1 bucket
+     * @param channel The channel the sample belongs to
+     * @param data The sample, unusable channels are skipped
+     */
+    void merge_late_sample(ParameterChannel channel, const SensorData& data);
+
+    /**
+     * @brief Add one sample to the history of all channels at its slot and log it to flash
+     * @param message The published sample with its timestamp
+     */
+    void ingest_sample(const QueueMessage& message);
+
+    // Latest sample of every sensor and its publish time in us, 0 before the first one
+    SensorData sensorLatest[SENSOR_COUNT] = {};
+    int64_t sensorLatestUs[SENSOR_COUNT] = {};
+
+    // Samples of other sensors older than this are left out of the average
+    static constexpr int64_t kSensorStaleUs = 2 * 1000000;
+
+    /**
+     * @brief Pick the sample the screens and charts show, see SENSOR_CHART_SOURCE
+     * @param message A published sample of any sensor
+     * @param shown Receives the sample to show
+     * @return false if the sample is not shown by itself
+     * @details In average mode the lowest sensor that is still publishing drives the charts'
+     *          clock, every other fresh sensor adds its latest value to each usable channel.
+     *          Nothing waits for a slower sensor.
+     */
+    bool select_sample(const QueueMessage& message, QueueMessage& shown);
+
+    /**
+     * @brief Get the buffers of a channel
+     * @param channel The channel
+     * @return The channel's parameter buffers
+     */
+    ParameterBuffers* channel_buffers(ParameterChannel channel) {
+        return &parameter_buffers[static_cast<size_t>(channel)];
+    }
+
+    /**
+     * @brief Rebuild all history tiers from the flash history store
+     */
+    void restore_history();
+
+    /**
+     * @brief Replay stored records of one level into that level of every channel
+     * @param level Pyramid level to replay
+     * @details Records only store the mean, restored points get it as their min and max.
+     */
+    void replay_history(uint8_t level);
+
+    /**
+     * @brief Insert a gap into every level after a reboot, the time spent powered off is unknown
+     */
+    void mark_history_gap();
     
     // Chart series pointers
     lv_chart_series_t* pm1_series;
@@ -134,10 +279,39 @@ private:
     lv_chart_series_t* temp_series;
     lv_chart_series_t* rh_series;
 
+    // Min/max band around the mean of a chart's main channel. On aggregated levels it keeps
+    // short spikes visible that the mean averages away.
+    struct EnvelopeSeries {
+        lv_chart_series_t* min_series;
+        lv_chart_series_t* max_series;
+    };
+    EnvelopeSeries pm_envelope;     // Around PM2.5
+    EnvelopeSeries co2_envelope;
+    EnvelopeSeries voc_envelope;
+    EnvelopeSeries nox_envelope;
+    EnvelopeSeries temp_envelope;
+    EnvelopeSeries rh_envelope;
+
+    // Cost of ingest_sample, reported in DEBUG_MODE
+    static constexpr uint32_t kIngestReportSamples = 300;
+    uint32_t ingestSamples = 0;
+    uint64_t ingestCpuUs = 0;
+
     // Display hardware
     TFT_eSPI tft;
     lv_disp_draw_buf_t draw_buf;
+#ifdef DISPLAY_BACKEND_I80_DMA
+    esp_lcd_panel_handle_t panel_handle = nullptr;
+    lv_color_t* dma_buffers[2] = {nullptr, nullptr};  // Allocated in DMA-capable RAM
+#else
     lv_color_t display_buffer[kBufferSize];
+#endif
+
+    // Frame rate counter, updated from the flush callback
+    volatile uint32_t frameCount = 0;
+    uint32_t fpsWindowStart = 0;
+    uint32_t fpsWindowFrames = 0;
+    float framesPerSecond = 0.0f;
 
     // State machine states
     enum class ScreenState {
@@ -160,6 +334,17 @@ private:
     bool inSettingsMode = false;
     bool processing = false;
     bool frcconfirmed = false;
+    uint32_t frcStartMs = 0;
+    uint8_t frcPendingReplies = 0;      // Sensors that have not reported their FRC result yet
+    bool frcFailed = false;             // A sensor rejected or failed the FRC
+    int32_t frcCorrection = 0;          // Correction of the lowest sensor that succeeded
+    uint8_t frcCorrectionSensor = 0;    // Sensor frcCorrection came from, SENSOR_COUNT before the first
+
+    // Results of commands submitted to the I2C task
+    QueueHandle_t sensorResultQueue = nullptr;
+
+    // Button events waiting for the display task
+    QueueHandle_t inputQueue = nullptr;
 
     // Screen management
     uint8_t currentScreenIndex = 0;
@@ -179,16 +364,33 @@ private:
     lv_obj_t* rh_min_label;
     lv_obj_t* rh_max_label;
 
+    // Latest sample, pulled by a screen when it becomes visible
+    SensorData latestData = {};
+    bool hasLatestData = false;
+
+    // Last rendered state of a value widget, the widget is only touched when this changes
+    struct WidgetCache {
+        char text[16];
+        ColorBand band;
+        bool has_band;
+    };
+
+    // Indexed by ParameterChannel, each channel has at most one tile and one value label
+    WidgetCache tile_cache[PARAMETER_CHANNEL_COUNT] = {};
+    WidgetCache value_cache[PARAMETER_CHANNEL_COUNT] = {};
+
     // Screen switching helper
     void switchScreen(uint8_t screenIndex);
 
-    // Indicator states
-    enum class IndicatorState {
-        Green,
-        Orange,
-        Red,
-        Blue
-    };
+    /**
+     * @brief Update the charts and labels of the currently loaded screen only
+     * @details Sample ingestion only fills the history buffers. Hidden screens are
+     *          brought up to date when switchScreen loads them.
+     */
+    void refresh_active_screen();
+
+    // Indicator states, taken from the channel's colour table
+    using IndicatorState = ColorBand;
 
     /**
      * @brief Initialize the display hardware and LVGL
@@ -209,12 +411,61 @@ private:
      */
     static void my_disp_flush(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p);
 
+#ifdef DISPLAY_BACKEND_I80_DMA
+    /**
+     * @brief Set up the i80 bus, the ST7789 panel and the DMA draw buffers
+     * @param disp_drv LVGL display driver to signal when a transfer is done
+     * @return true if the panel and both buffers are ready
+     */
+    bool init_i80_panel(lv_disp_drv_t* disp_drv);
+
+    /**
+     * @brief Called by the LCD peripheral when a DMA color transfer has finished
+     * @param panel_io Panel IO handle
+     * @param edata Event data (unused)
+     * @param user_ctx LVGL display driver
+     * @return Whether a higher priority task was woken (never)
+     */
+    static bool on_color_trans_done(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t* edata, void* user_ctx);
+#endif
+
+    /**
+     * @brief Recalculate the frames per second once per measurement window
+     */
+    void update_frame_rate();
+
+    /**
+     * @brief Apply a sensor command result to the UI
+     * @param result Result sent back by the I2C task
+     */
+    void handle_sensor_result(const SensorCommandResult& result);
+
+    /**
+     * @brief Run the handler of a queued button event
+     * @param input The button event
+     */
+    void handle_input(DisplayInput input);
+
+    // Button handlers, run on the display task through handle_input
+    void handleLeftButtonPress();
+    void handleRightButtonPress();
+    void handleLeftButtonLongPress();
+    void handleRightButtonLongPress();
+
+    /**
+     * @brief Show the outcome of a forced recalibration on the FRC screen
+     * @param success Whether the recalibration succeeded
+     * @param correction Correction applied by the sensor in ppm
+     */
+    void show_frc_result(bool success, int32_t correction);
+
     /**
      * @brief Update a tile's value with a float
      * @param tile The tile object to update
+     * @param channel The channel shown on the tile
      * @param value The new value to display
      */
-    void update_tile_value(lv_obj_t* tile, float value);
+    void update_tile_value(lv_obj_t* tile, ParameterChannel channel, float value);
 
     /**
      * @brief Update a tile's indicator state
@@ -223,6 +474,30 @@ private:
      */
     void update_indicator_state(lv_obj_t* tile, IndicatorState state);
 
+    /**
+     * @brief Update a tile's indicator if the value moved to another colour band
+     * @param tile The tile object to update
+     * @param channel The channel shown on the tile
+     * @param value The value the band is taken from
+     */
+    void update_tile_indicator(lv_obj_t* tile, ParameterChannel channel, float value);
+
+    /**
+     * @brief Set a label's text unless it already shows it
+     * @param cache The label's cached state
+     * @param label The label object to update
+     * @param text The text to show
+     */
+    void set_cached_text(WidgetCache& cache, lv_obj_t* label, const char* text);
+
+    /**
+     * @brief Record a widget's colour band
+     * @param cache The widget's cached state
+     * @param band The band to show
+     * @return true if the band changed and the widget has to be restyled
+     */
+    bool set_cached_band(WidgetCache& cache, ColorBand band);
+
     /**
      * @brief Update all tile indicators based on sensor data
      * @param data The sensor data to evaluate
@@ -232,34 +507,68 @@ private:
     /**
      * @brief Update a label's text and color based on a value
      * @param label The label object to update
+     * @param channel The channel shown in the label
      * @param value The value to display
-     * @param decimals The number of decimal places to display
      */
-    void update_value_text(lv_obj_t* label, float value, uint8_t decimals);
+    void update_value_text(lv_obj_t* label, ParameterChannel channel, float value);
+
+    /**
+     * @brief Allocate the history buffers of all channels
+     * @return false if there is not enough memory
+     */
+    bool allocate_buffers();
 
     /**
      * @brief Initialize all buffers
      */
     void init_buffers();
+
+    /**
+     * @brief Reset all levels and accumulators of one parameter
+     * @param buffers The parameter buffers to reset
+     */
+    void clear_parameter_buffers(ParameterBuffers* buffers);
     
     /**
-     * @brief Update a ring buffer with a new value
-     * @param buffer The ring buffer to update
-     * @param value The new value to add
+     * @brief Get the history tier shown for the current chart level
+     * @param buffers The parameter buffers to select from
+     * @return The active history tier
      */
-    void update_ring_buffer(lv_coord_t* buffer, float value);
+    HistoryTier* active_tier(ParameterBuffers* buffers);
     
     /**
-     * @brief Validate and scale a sensor value based on its type
-     * @param buffer The ring buffer the value will be stored in
-     * @param value The raw sensor value to validate and scale
-     * @return The scaled value, or -1.0f if the value is invalid
+     * @brief Scale a channel of a sample to a chart point, integer arithmetic only
+     * @param channel The channel to convert
+     * @param data The sample in the sensor's integer scaling
+     * @return The chart point, LV_CHART_POINT_NONE if the I2C task flagged the channel unusable
      */
-    float valid_value(lv_coord_t* buffer, float value);
+    lv_coord_t chart_point(ParameterChannel channel, const SensorData& data);
     
+    /**
+     * @brief Add the min/max envelope series of a chart
+     * @param chart The chart object
+     * @param color Colour of the band, a dimmed version of the mean's colour
+     * @return The envelope series
+     * @details Must be called before the chart's other series are added, so the band is drawn behind them.
+     */
+    EnvelopeSeries add_envelope_series(lv_obj_t* chart, lv_color_t color);
+
+    /**
+     * @brief Point the envelope series at the min/max points of the displayed level
+     * @param chart The chart object
+     * @param envelope The chart's envelope series
+     * @param buffer The buffers of the channel the band belongs to
+     * @details Hidden on level 0, where min and max equal the samples.
+     */
+    void update_envelope_series(lv_obj_t* chart, const EnvelopeSeries& envelope, ParameterBuffers* buffer);
+
     /**
      * @brief Update chart series with ring buffer values
      * @param chart The chart object
+     * @param channel The channel whose range settings and envelope the chart uses
+     * @param min_label Label showing the bottom of the chart range
+     * @param max_label Label showing the top of the chart range
+     * @param envelope The chart's min/max envelope series
      * @param series The series to update
      * @param buffer The ring buffer containing the values
      * @param series2 Optional second series (for PM chart)
@@ -269,7 +578,8 @@ private:
      * @param series4 Optional fourth series (for PM chart)
      * @param buffer4 Optional fourth buffer (for PM chart)
      */
-    void update_chart_series(lv_obj_t* chart, lv_chart_series_t* series, ParameterBuffers* buffer,
+    void update_chart_series(lv_obj_t* chart, ParameterChannel channel, lv_obj_t* min_label, lv_obj_t* max_label,
+                           const EnvelopeSeries& envelope, lv_chart_series_t* series, ParameterBuffers* buffer,
                            lv_chart_series_t* series2 = nullptr, ParameterBuffers* buffer2 = nullptr,
                            lv_chart_series_t* series3 = nullptr, ParameterBuffers* buffer3 = nullptr,
                            lv_chart_series_t* series4 = nullptr, ParameterBuffers* buffer4 = nullptr);
@@ -277,23 +587,34 @@ private:
     /**
      * @brief Calculate and set adaptive range for a chart based on its data
      * @param chart The chart object
-     * @param buffer The data buffer
-     * @param default_min Default minimum value
-     * @param default_max Default maximum value
-     * @param min_spread Minimum required spread between min and max values
-     * @param buffer2 Optional second buffer (for PM chart)
-     * @param buffer3 Optional third buffer (for PM chart)
-     * @param buffer4 Optional fourth buffer (for PM chart)
+     * @param descriptor Descriptor with the chart's default range, minimum spread and decimals
+     * @param min_label Label showing the bottom of the chart range
+     * @param max_label Label showing the top of the chart range
+     * @param tier The displayed history tier
+     * @param tier2 Optional second tier (for PM chart)
+     * @param tier3 Optional third tier (for PM chart)
+     * @param tier4 Optional fourth tier (for PM chart)
+     */
+    void calculate_adaptive_range(lv_obj_t* chart, const ParameterDescriptor& descriptor,
+                                lv_obj_t* min_label, lv_obj_t* max_label, const HistoryTier* tier,
+                                const HistoryTier* tier2 = nullptr, const HistoryTier* tier3 = nullptr,
+                                const HistoryTier* tier4 = nullptr);
+
+    /**
+     * @brief Add the Chart Time Screen checkboxes of the levels the generated UI lacks
+     */
+    void create_chart_window_checkboxes();
+
+    /**
+     * @brief Show a history level on all charts and check its checkbox
+     * @param level The level to show
      */
-    void calculate_adaptive_range(lv_obj_t* chart, lv_coord_t* buffer, 
-                                float default_min, float default_max, float min_spread,
-                                lv_coord_t* buffer2 = nullptr, lv_coord_t* buffer3 = nullptr,
-                                lv_coord_t* buffer4 = nullptr);
+    void set_chart_level(uint8_t level);
 
     /**
-     * @brief Cycle through the chart display modes
+     * @brief Cycle through the chart windows
      * @param up Whether to cycle up or down
-     * @param reset Whether to reset the display mode to the saved value
+     * @param reset Whether to reset the window to the saved value
      */
     void cycleChartDisplayMode(bool up = false, bool reset = false);
 };
\ No newline at end of file
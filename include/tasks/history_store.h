@@ -0,0 +1,129 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <esp_partition.h>
+#include "definitions.h"
+#include "parameter_descriptors.h"
+
+// Configuration
+#define HISTORY_PARTITION_LABEL   "history"
+#define HISTORY_PARTITION_SUBTYPE 0x40      // Custom data subtype, see partitions_history.csv
+#define HISTORY_CHANNELS          PARAMETER_CHANNEL_COUNT  // Values in ParameterChannel order
+#define HISTORY_SECTOR_SIZE       4096      // Flash erase unit
+#define HISTORY_PENDING_RECORDS   16        // Records buffered in RAM per region before they are dropped
+#define HISTORY_BATCH_RECORDS     8         // Records per flash write, one 256 byte flash page
+#define HISTORY_LEVELS            7         // Aggregate pyramid levels, level 0 holds the 1 second samples
+#define HISTORY_IMMEDIATE_LEVEL   3         // Records of this level and up are flushed as soon as they arrive
+#define HISTORY_MIN_LEVEL_SECTORS 3         // Keeps a full chart of records while the oldest sector is erased
+#define HISTORY_RECORD_FORMAT     1         // Records with another format are ignored
+
+// Flash record, 32 bytes so records never straddle a flash page or sector
+struct HistoryRecord {
+    uint32_t sequence;                  // Increasing per region, 0xFFFFFFFF marks erased flash
+    uint8_t level;                      // Pyramid level, each level lives in its own region
+    uint8_t format;                     // HISTORY_RECORD_FORMAT
+    uint16_t channelMask;               // Channels carrying a value
+    int16_t values[HISTORY_CHANNELS];   // Chart points, LV_CHART_POINT_NONE for a gap
+    uint16_t boot;                      // Boot counter, a change between records is a gap
+    uint16_t gapsBefore;                // Gap points of this level between the previous record and this one
+    uint16_t crc;                       // CRC-16/CCITT over all preceding bytes
+};
+static_assert(sizeof(HistoryRecord) == 32, "HistoryRecord must stay 32 bytes");
+
+// Position of a backwards walk over the records of one type
+struct HistoryCursor {
+    uint8_t level;          // Pyramid level
+    uint32_t position;      // Record index after the next record to return
+    uint32_t expected;      // Sequence number the next record must have
+    uint32_t remaining;     // Records left before the walk wraps onto itself
+};
+
+// One append-only sector ring inside the partition
+struct HistoryRegion {
+    uint32_t offset;        // Start offset within the partition
+    uint32_t size;          // Size in bytes, a multiple of HISTORY_SECTOR_SIZE
+    uint32_t writeOffset;   // Next record position relative to offset
+    uint32_t readOffset;    // Position after the newest record in flash
+    uint32_t lastSequence;  // Sequence of the newest record in flash, 0 if empty
+    uint32_t nextSequence;  // Sequence of the next record
+    HistoryRecord pending[HISTORY_PENDING_RECORDS];
+    uint8_t pendingCount;
+    uint32_t dropped;       // Records lost because the flash writer fell behind
+};
+
+class HistoryStore {
+public:
+    static HistoryStore& getInstance();
+
+    /**
+     * @brief Locate the history partition and find the write position of each region
+     * @return true if the partition exists and the store is usable
+     */
+    bool begin();
+
+    /**
+     * @brief Static task function writing buffered records to flash
+     * @param parameter Task parameters (unused)
+     */
+    static void historyStoreTask(void* parameter);
+
+    /**
+     * @brief Buffer a record for writing, never touches flash on the caller's thread
+     * @param level Pyramid level, selects the region
+     * @param channelMask Channels carrying a value
+     * @param values One value per channel
+     * @param gapsBefore Points of this level since the previous record that are not stored
+     * @return true if the record was buffered
+     */
+    bool append(uint8_t level, uint16_t channelMask, const int16_t values[HISTORY_CHANNELS], uint16_t gapsBefore = 0);
+
+    /**
+     * @brief Read the most recent records of one level, oldest first
+     * @param level Pyramid level to read
+     * @param records Destination buffer
+     * @param maxRecords Capacity of records
+     * @param perChannel Stop once every channel has this many values (0 = fill the buffer)
+     * @return Number of records read
+     * @details A change of the boot field between two returned records marks a gap in the history.
+     */
+    size_t readLatest(uint8_t level, HistoryRecord* records, size_t maxRecords, size_t perChannel = 0);
+
+    /**
+     * @brief Start a walk from the newest record of one level that is already in flash
+     * @param level Pyramid level to walk
+     * @param cursor Cursor to initialize
+     */
+    void openCursor(uint8_t level, HistoryCursor& cursor);
+
+    /**
+     * @brief Read the next older record of the cursor's level
+     * @param cursor Cursor opened with openCursor
+     * @param record Receives the record
+     * @return false once the oldest intact record has been returned
+     */
+    bool readPrevious(HistoryCursor& cursor, HistoryRecord& record);
+
+    // Boot counter stored in new records
+    uint16_t currentBoot() const { return _boot; }
+
+    // Task handle
+    static TaskHandle_t xHistoryStoreTaskHandle;
+
+private:
+    HistoryStore() = default;
+    ~HistoryStore() = default;
+    HistoryStore(const HistoryStore&) = delete;
+    HistoryStore& operator=(const HistoryStore&) = delete;
+
+    const esp_partition_t* _partition = nullptr;
+    HistoryRegion _regions[HISTORY_LEVELS] = {};  // Indexed by level
+    uint16_t _boot = 0;
+    portMUX_TYPE _pendingLock = portMUX_INITIALIZER_UNLOCKED;
+
+    // Helper methods
+    bool readRecord(const HistoryRegion& region, uint32_t position, HistoryRecord& record);
+    void scanRegion(HistoryRegion& region, uint16_t& lastBoot);
+    void flushRegion(HistoryRegion& region, bool force);
+};
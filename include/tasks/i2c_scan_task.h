@@ -5,55 +5,261 @@
 #include <SensirionI2cSen66.h>
 #include <FreeRTOS.h>
 #include <task.h>
+#include <queue.h>
 #include <Preferences.h>
 #include "definitions.h"
+#include "sen66_readout.h"
+#include "i2c_bus.h"
 
+// SEN66 device status error bits, see the datasheet's read device status command
+#define SEN66_STATUS_FAN_ERROR (1UL << 4)   // Fan stuck or blocked, PM values are wrong
+#define SEN66_STATUS_RHT_ERROR (1UL << 6)   // Humidity/temperature sensor communication error
+#define SEN66_STATUS_GAS_ERROR (1UL << 7)   // VOC/NOx sensor communication error
+#define SEN66_STATUS_CO2_ERROR (1UL << 9)   // CO2 sensor communication error
+#define SEN66_STATUS_PM_ERROR  (1UL << 11)  // PM sensor communication error
+
+// Acquisition scheduler statistics
+struct AcquisitionStats {
+    uint32_t samples;           // Samples read since the last (re)start
+    Sen66BusCounters bus;       // I2C traffic spent on those samples
+    uint32_t latePolls;         // Polls past the predicted data-ready time and its jitter that found no sample
+    float periodMs;             // Learned sensor sample period
+    float jitterAvgMs;          // Mean absolute deviation from the predicted data-ready time
+    uint32_t jitterMaxMs;       // Largest deviation from the predicted data-ready time
+};
+
+#define VOC_STATE_SIZE            8      // Bytes of the SEN66 VOC algorithm state
+#define VOC_STATE_FORMAT_VERSION  3      // Bumped when VocStateCheckpoint changes
+#define SEN66_SERIAL_NUMBER_SIZE  32
+
+// VOC algorithm state as kept in RAM and NVS
+struct VocStateCheckpoint {
+    uint8_t version;                            // VOC_STATE_FORMAT_VERSION
+    uint8_t state[VOC_STATE_SIZE];
+    uint32_t savedAt;                           // s, system time when the state was read
+    uint32_t uptime;                            // s since boot when the state was read
+    uint16_t boot;                              // NVS boot counter when the state was read
+    uint32_t learningSeconds;                   // s, how long the algorithm had learned, restored runs included
+    char serialNumber[SEN66_SERIAL_NUMBER_SIZE];// Sensor the state belongs to
+};
+
+// Commands executed by the I2C task between measurements
+enum class SensorCommandType : uint8_t {
+    SetAltitude,            // value: altitude in meters, persisted in NVS by sensor 0
+    ForcedRecalibration,    // value: reference CO2 concentration in ppm
+    FanCleaning,            // value: unused
+    ShtHeater               // value: unused
+};
+
+// Result of an executed sensor command
+struct SensorCommandResult {
+    SensorCommandType type;
+    bool success;
+    int32_t value;          // FRC: correction in ppm, SetAltitude: applied altitude
+    uint8_t sensorId;       // Sensor that executed the command
+};
+
+// Sensor command with an optional completion notification
+struct SensorCommand {
+    SensorCommandType type;
+    int32_t value;
+    QueueHandle_t replyQueue;   // Receives a SensorCommandResult, may be nullptr
+    TaskHandle_t replyTask;     // Notified with replyBits once the result is queued, may be nullptr
+    uint32_t replyBits;
+};
+
+/**
+ * @class I2CScanTask
+ * @brief Acquisition of one SEN66, one instance and task per sensor and bus
+ *
+ * Sensor 0 sits on Wire. With SENSOR_COUNT 2 a second sensor on Wire1 runs its own task,
+ * so a slow or failing bus never delays the other sensor's samples.
+ */
 class I2CScanTask {
 public:
-    static I2CScanTask& getInstance() {
-        static I2CScanTask instance;
-        return instance;
-    }
     /**
-     * @brief Sets the current altitude for sensor compensation
-     * @param altitude Altitude in meters above sea level
-     * @details Updates the stored altitude value used for environmental compensation
-     *          in sensor measurements. Altitude affects air pressure and density.
-     *          The value is persisted in non-volatile storage.
+     * @brief Get the acquisition of one sensor
+     * @param sensorId Sensor ID, 0 to SENSOR_COUNT - 1
+     * @return The sensor's instance, sensor 0 for an unknown ID
+     */
+    static I2CScanTask& getInstance(uint8_t sensorId = 0);
+
+    /**
+     * @brief Queues a command for the I2C task without waiting for it to run
+     * @param command Command to execute
+     * @return true if the command was queued, false if the queue is full or the task is not running
+     * @details Commands run in order between measurements. The measurement is stopped,
+     *          the command executed and the measurement restarted. When the command
+     *          has finished a SensorCommandResult is sent to command.replyQueue and
+     *          command.replyTask is notified with command.replyBits.
+     */
+    bool submitCommand(const SensorCommand& command);
+
+    /**
+     * @brief Queue a command for every sensor, e.g. an altitude that applies to all of them
+     * @param command Command to execute, every sensor that queued it sends its own reply
+     * @return Number of sensors that queued the command, SENSOR_COUNT if all did
      */
-    void setAltitude(int32_t altitude);
+    static uint8_t submitCommandToAll(const SensorCommand& command);
 
     /**
-     * @brief Sets the Fast Response Curve (FRC) value for CO2 calibration
-     * @param frcValue Target CO2 concentration in parts per million (ppm)
-     * @param timeout Maximum time in milliseconds to wait for calibration
-     * @return The calibration correction value in ppm, or original frcValue if timeout occurs
-     * @details Performs forced recalibration of the CO2 sensor using a reference gas concentration.
-     *          The correction value indicates the sensor's offset from the reference.
-     *          A positive correction means the sensor was reading too low.
-     *          A negative correction means the sensor was reading too high.
+     * @brief Get the acquisition scheduler statistics
+     * @return Statistics since the last measurement (re)start
      */
-    int16_t setFRCValue(int32_t frcValue, uint32_t timeout = 3000);
+    const AcquisitionStats& getAcquisitionStats() const { return stats; }
+
+    /**
+     * @brief Get the manager of the sensor's bus
+     * @return The bus, for its clock and error statistics
+     */
+    const I2CBus& getBus() const { return bus; }
+
+    // Sensor ID stamped on every published sample
+    uint8_t getSensorId() const { return sensorId; }
 
-    // Static task function
+    /**
+     * @brief Static task function, one task per sensor
+     * @param parameter The I2CScanTask to run, nullptr for sensor 0
+     */
     static void i2cScanTask(void* parameter);
 
 private:
-    I2CScanTask() = default;
+    I2CScanTask(uint8_t sensorId, TwoWire& wire, int sda, int scl, uint8_t address);
     ~I2CScanTask() = default;
     I2CScanTask(const I2CScanTask&) = delete;
     I2CScanTask& operator=(const I2CScanTask&) = delete;
 
-    static int32_t currentAltitude;  // Altitude in meters
-    static bool applyAltitude;
-    static int32_t currentFRCValue;  // FRC value in ppm
-    static bool performFRC;
-    static uint16_t ucorrection;    // unsinged Correction value for FRC calibration
-    static int16_t correction;      // Correction value for FRC calibration
+    static constexpr size_t kCommandQueueSize = 4;
+
+    uint8_t sensorId;
+    uint8_t address;                    // 7 bit I2C address of the sensor
+    TaskHandle_t taskHandle = nullptr;
+    int32_t currentAltitude = 0;        // Altitude in meters
+    QueueHandle_t commandQueue = nullptr;
     
-    // Static sensor initialization function
-    static bool initSensor(SensirionI2cSen66& sensor);
+    // Bus the sensor is attached to
+    I2CBus bus;
+
+    // Acquisition loop of the task
+    void run();
+
+    // Sensor initialization
+    bool initSensor(SensirionI2cSen66& sensor);
+
+    /**
+     * @brief Initialize the sensor, retrying with exponential backoff until it answers
+     * @param sensor Sensor driver
+     * @details The bus is recovered between attempts, the wait doubles from
+     *          SENSOR_RETRY_MIN_TIME up to SENSOR_RETRY_MAX_TIME.
+     */
+    void startSensor(SensirionI2cSen66& sensor);
+
+    // Wake the task so a queued command is executed immediately
+    void wakeTask();
+
+    /**
+     * @brief Execute a command with the measurement stopped and report the result
+     * @param sensor Sensor driver
+     * @param command Command to execute
+     */
+    void executeCommand(SensirionI2cSen66& sensor, const SensorCommand& command);
+
+    // VOC algorithm checkpoint, restored on every sensor initialization
+    VocStateCheckpoint vocCheckpoint = {};
+    bool vocCheckpointValid = false;
+    bool vocCheckpointThisBoot = false; // Read or restored in this boot, otherwise loaded from NVS
+    char serialNumber[SEN66_SERIAL_NUMBER_SIZE] = {};
+    uint32_t vocLearningBase = 0;       // s the restored state had learned before this run
+    uint32_t vocLearningStartMs = 0;    // Time the measurement started learning from vocLearningBase
+    uint32_t vocReadMs = 0;             // Time of the last VOC state read
+    uint32_t vocSavedMs = 0;            // Time of the last NVS write
+    bool vocSaved = false;              // NVS holds a checkpoint written in this boot
+
+    /**
+     * @brief Load the NVS checkpoint into RAM, once per boot
+     * @details The RAM checkpoint is newer than NVS after the first read, so a
+     *          re-initialization after bus errors restores the freshest state.
+     */
+    void loadVocCheckpoint();
+
+    /**
+     * @brief Write the VOC algorithm state to an idle sensor
+     * @param sensor Sensor driver, the measurement must not be running
+     * @details The checkpoint is skipped if it belongs to another sensor or
+     *          vocCheckpointRejection refuses it. A restored checkpoint from NVS is
+     *          stamped and saved as this boot's.
+     */
+    void restoreVocState(SensirionI2cSen66& sensor);
+
+    /**
+     * @brief Apply the restore policy to the checkpoint
+     * @return nullptr if it may be restored, otherwise the reason it may not
+     * @details A checkpoint of this boot is timed by the uptime, one taken after a reset
+     *          by the system time, which keeps running until the next power cycle. After
+     *          a power cycle only a checkpoint written by the previous boot is restored:
+     *          the off-time is unknown, but that checkpoint trails the sensor by at most
+     *          VOC_STATE_MAX_OFF_TIME.
+     */
+    const char* vocCheckpointRejection() const;
+
+    /**
+     * @brief Mark the checkpoint as taken now, in this boot
+     */
+    void stampVocCheckpoint();
+
+    /**
+     * @brief Write the checkpoint to NVS
+     * @param now Current time in ms
+     * @return true if it was written
+     */
+    bool saveVocCheckpoint(uint32_t now);
+
+    /**
+     * @brief Read the VOC algorithm state when due and write it to NVS, rate limited
+     * @param sensor Sensor driver
+     * @param now Current time in ms
+     */
+    void checkpointVocState(SensirionI2cSen66& sensor, uint32_t now);
+
+    // Channels the last device status read reported an error for
+    uint16_t statusErrorChannels = 0;
+
+    /**
+     * @brief Set the quality bits and unusable channels of a freshly read sample
+     * @param sensor Sensor driver, the device status is read every SENSOR_STATUS_CHECK_SAMPLES samples
+     * @param data Sample with runtime_ticks already counted
+     */
+    void assessQuality(SensirionI2cSen66& sensor, SensorData& data);
+
+    // Acquisition scheduler state
+    AcquisitionStats stats = {};
+    bool phaseLocked = false;           // true once a data-ready edge has been observed
+    uint32_t lastReadyMs = 0;           // Estimated time of the last data-ready edge
+    uint32_t nextPollMs = 0;            // Time of the next getDataReady poll
+    uint32_t lastFailedPollMs = 0;      // Time of the last poll that found no data
+    bool sampleLate = false;            // A poll for the current sample found no data
+
+    /**
+     * @brief Forget the learned phase after the measurement was (re)started
+     * @param now Current time in ms
+     */
+    void resetAcquisitionSchedule(uint32_t now);
+
+    /**
+     * @brief Update the learned phase and period after a sample became ready
+     * @param pollMs Time of the poll that found the sample
+     */
+    void onSampleReady(uint32_t pollMs);
+
+    /**
+     * @brief Schedule a short re-poll after a poll found no sample
+     * @param pollMs Time of the poll that found no sample
+     */
+    void onSampleNotReady(uint32_t pollMs);
 };
 
-// Task handle declaration
-extern TaskHandle_t xI2CScanTaskHandle; 
\ No newline at end of file
+// Task handle declarations
+extern TaskHandle_t xI2CScanTaskHandle;
+#if SENSOR_COUNT > 1
+extern TaskHandle_t xI2CScanTask1Handle;
+#endif 
\ No newline at end of file
@@ -3,41 +3,59 @@
 #include <Arduino.h>
 #include <FreeRTOS.h>
 #include <task.h>
-#include <queue.h>
+#include <atomic>
 #include "definitions.h"
 
 // Configuration
 #define MAX_SUBSCRIBERS 5
-#define QUEUE_SIZE 10
-#define QUEUE_TIMEOUT_MS 100
+#define SAMPLE_SLOTS (4 * SENSOR_COUNT) // Samples a subscriber may fall behind before it skips ahead
+#define LIVE_DATA_NOTIFY_BIT (1UL << 0) // Task notification bit set on every publish
 
 // Queue message structure
 struct QueueMessage {
     SensorData data;
-    uint32_t timestamp;
+    uint32_t timestamp;     // Publish time in ms, wraps after 49 days
+    int64_t timestampUs;    // Publish time in us from esp_timer, monotonic and never wraps
 };
 
 // Subscription structure
 struct Subscription {
     TaskHandle_t subscriber;
-    QueueHandle_t queue;
     bool active;
 };
 
+// Sample slot guarded by a sequence lock, odd lock values mean a write is in progress
+struct SampleSlot {
+    std::atomic<uint32_t> lock;
+    std::atomic<uint32_t> sequence;
+    QueueMessage message;
+};
+
 class LiveDataManager {
 public:
     static LiveDataManager& getInstance();
     
-    // Task function
-    static void liveDataManagerTask(void* parameter);
-    
     // Public interface
-    bool subscribe(TaskHandle_t subscriber, QueueHandle_t* queue);
+    bool subscribe(TaskHandle_t subscriber);
     void unsubscribe(TaskHandle_t subscriber);
     bool publish(const SensorData& data);
-    
-    // Task handle
-    static TaskHandle_t xLiveDataManagerTaskHandle;
+
+    /**
+     * @brief Get the sequence number of the most recently published sample
+     * @return Sequence number, 0 if nothing has been published yet
+     */
+    uint32_t latestSequence() const { return _publishedSequence.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Read the sample following lastSequence from the shared store
+     * @param lastSequence Last sequence the caller has consumed, advanced on success
+     * @param message Destination for the sample
+     * @return true if a newer sample was read, false if the caller is up to date
+     *
+     * A subscriber that fell more than SAMPLE_SLOTS behind skips to the oldest
+     * sample still stored. Never blocks the producer or other subscribers.
+     */
+    bool readNext(uint32_t& lastSequence, QueueMessage& message) const;
 
 private:
     LiveDataManager() = default;
@@ -45,13 +63,17 @@ private:
     LiveDataManager(const LiveDataManager&) = delete;
     LiveDataManager& operator=(const LiveDataManager&) = delete;
 
-    // Queue handles
-    QueueHandle_t _ingressQueue;
-    Subscription _subscriptions[MAX_SUBSCRIBERS];
+    // Shared sample store, written by the single producer only
+    SampleSlot _slots[SAMPLE_SLOTS] = {};
+    std::atomic<uint32_t> _publishedSequence{0};
+    portMUX_TYPE _publishLock = portMUX_INITIALIZER_UNLOCKED;
+
+    Subscription _subscriptions[MAX_SUBSCRIBERS] = {};
+    portMUX_TYPE _subscriptionLock = portMUX_INITIALIZER_UNLOCKED;
     
     // Helper methods
-    bool addSubscription(TaskHandle_t subscriber, QueueHandle_t queue);
+    bool addSubscription(TaskHandle_t subscriber);
     bool removeSubscription(TaskHandle_t subscriber);
-    void forwardData(const QueueMessage& message);
-    void handleQueueError(const char* operation);
-}; 
\ No newline at end of file
+    bool readSlot(uint32_t sequence, QueueMessage& message) const;
+    void notifySubscribers();
+};
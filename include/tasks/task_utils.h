@@ -21,4 +21,22 @@ BaseType_t launchTaskWithVerification(
     void* pvParameters,
     UBaseType_t uxPriority,
     TaskHandle_t* pxCreatedTask
-); 
\ No newline at end of file
+);
+
+#ifdef DEBUG_MODE
+#define WAKEUP_REPORT_INTERVAL_MS 10000  // How often task wakeup rates are printed
+
+// Wakeup statistics of a single task loop
+struct TaskWakeupCounter {
+    const char* name;
+    uint32_t wakeups;
+    uint32_t windowStart;
+};
+
+/**
+ * @brief Counts one wakeup of a task loop and prints the wakeup rate periodically
+ * 
+ * @param counter Wakeup statistics of the calling task
+ */
+void countTaskWakeup(TaskWakeupCounter& counter);
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary telemetry framing: payload + CRC-16 (little endian), COBS encoded, 0x00 terminated.
+// Every payload starts with the protocol version and a TelemetryRecordType.
+#define TELEMETRY_PROTOCOL_VERSION 4
+#define TELEMETRY_MAX_PAYLOAD      64
+#define TELEMETRY_MAX_FRAME        (TELEMETRY_MAX_PAYLOAD + 2 + 2 + 1)  // + CRC, COBS overhead, delimiter
+
+enum class TelemetryRecordType : uint8_t {
+    Sample = 1,     // TelemetrySample
+    History = 2,    // Header followed by one HistoryRecord from the flash store
+    DumpEnd = 3     // Header followed by the uint32_t number of history records sent
+};
+
+// Common payload header
+struct __attribute__((packed)) TelemetryHeader {
+    uint8_t version;
+    uint8_t type;           // TelemetryRecordType
+};
+
+// Live sample in the sensor's own integer scaling
+struct __attribute__((packed)) TelemetrySample {
+    TelemetryHeader header;
+    uint32_t timestamp;     // ms since boot
+    uint32_t runtimeTicks;  // Samples since the measurement was started
+    uint16_t pm1p0;         // µg/m³ x 10
+    uint16_t pm2p5;         // µg/m³ x 10
+    uint16_t pm4p0;         // µg/m³ x 10
+    uint16_t pm10p0;        // µg/m³ x 10
+    int16_t humidity;       // % x 100
+    int16_t temperature;    // °C x 200
+    int16_t vocIndex;       // x 10
+    int16_t noxIndex;       // x 10
+    uint16_t co2;           // ppm
+    int16_t rawHumidity;    // % x 100
+    int16_t rawTemperature; // °C x 200
+    uint16_t rawVOC;        // ticks
+    uint16_t rawNOx;        // ticks
+    uint16_t rawCO2;        // ppm
+    uint16_t numberConc0p5; // particles/cm³ x 10, updated every SEN66_NUMBER_CONC_INTERVAL samples
+    uint16_t numberConc1p0; // particles/cm³ x 10
+    uint16_t numberConc2p5; // particles/cm³ x 10
+    uint16_t numberConc4p0; // particles/cm³ x 10
+    uint16_t numberConc10p0;// particles/cm³ x 10
+    uint8_t sensorId;       // Sensor that took the sample, 0 unless built with SENSOR_COUNT > 1
+};
+static_assert(sizeof(TelemetrySample) <= TELEMETRY_MAX_PAYLOAD, "TelemetrySample exceeds the frame size");
+
+/**
+ * @brief Build a complete frame from a payload
+ * @param payload Payload bytes, at most TELEMETRY_MAX_PAYLOAD
+ * @param length Payload length
+ * @param frame Output buffer of at least TELEMETRY_MAX_FRAME bytes
+ * @return Frame length including the 0x00 delimiter, 0 if the payload is too long
+ */
+size_t telemetry_encode_frame(const uint8_t* payload, size_t length, uint8_t* frame);
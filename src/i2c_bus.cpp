@@ -0,0 +1,80 @@
+#include "i2c_bus.h"
+#include <algorithm>
+
+bool I2CBus::begin() {
+    _clock = I2C_BUS_MAX_CLOCK;
+    _consecutiveErrors = 0;
+    _consecutiveSuccesses = 0;
+
+    // A reset of the ESP32 alone leaves a slave stuck mid-byte, clear the bus first
+    pinMode(_sda, INPUT_PULLUP);
+    if (digitalRead(_sda) == LOW) {
+        recover();
+    }
+    return _wire.begin(_sda, _scl, _clock);
+}
+
+bool I2CBus::recover() {
+    _stats.recoveries++;
+    _wire.end();
+
+    // Drive SCL as open drain, SDA is only watched until the slave lets go of it
+    pinMode(_sda, INPUT_PULLUP);
+    pinMode(_scl, OUTPUT_OPEN_DRAIN);
+    digitalWrite(_scl, HIGH);
+    for (uint8_t pulse = 0; pulse < I2C_BUS_RECOVERY_PULSES && digitalRead(_sda) == LOW; pulse++) {
+        digitalWrite(_scl, LOW);
+        delayMicroseconds(I2C_BUS_HALF_PERIOD_US);
+        digitalWrite(_scl, HIGH);
+        delayMicroseconds(I2C_BUS_HALF_PERIOD_US);
+    }
+
+    // STOP condition: SDA rises while SCL is high
+    pinMode(_sda, OUTPUT_OPEN_DRAIN);
+    digitalWrite(_sda, LOW);
+    delayMicroseconds(I2C_BUS_HALF_PERIOD_US);
+    digitalWrite(_scl, HIGH);
+    delayMicroseconds(I2C_BUS_HALF_PERIOD_US);
+    digitalWrite(_sda, HIGH);
+    delayMicroseconds(I2C_BUS_HALF_PERIOD_US);
+
+    pinMode(_sda, INPUT_PULLUP);
+    bool released = digitalRead(_sda) == HIGH;
+
+    #ifdef DEBUG_MODE
+    Serial.printf("I2C bus recovery %s, restarting at %u Hz\n", released ? "released SDA" : "failed, SDA still low",
+                  (unsigned)_clock);
+    #endif
+
+    _wire.begin(_sda, _scl, _clock);
+    return released;
+}
+
+void I2CBus::reportSuccess() {
+    _consecutiveErrors = 0;
+    if (_clock >= I2C_BUS_MAX_CLOCK || ++_consecutiveSuccesses < I2C_BUS_STEP_UP_SUCCESSES) {
+        return;
+    }
+    _stats.stepUps++;
+    setClock(std::min<uint32_t>(_clock * 2, I2C_BUS_MAX_CLOCK));
+}
+
+void I2CBus::reportError() {
+    _stats.errors++;
+    _consecutiveSuccesses = 0;
+    if (++_consecutiveErrors % I2C_BUS_STEP_DOWN_ERRORS != 0 || _clock <= I2C_BUS_MIN_CLOCK) {
+        return;
+    }
+    _stats.stepDowns++;
+    setClock(std::max<uint32_t>(_clock / 2, I2C_BUS_MIN_CLOCK));
+}
+
+void I2CBus::setClock(uint32_t clock) {
+    _clock = clock;
+    _consecutiveSuccesses = 0;
+    _wire.setClock(clock);
+
+    #ifdef DEBUG_MODE
+    Serial.printf("I2C clock set to %u Hz\n", (unsigned)clock);
+    #endif
+}
@@ -0,0 +1,81 @@
+#include "i2c_profiler.h"
+#include <FreeRTOS.h>
+
+static I2CCommandProfile profiles[SENSOR_COUNT][I2C_COMMAND_COUNT] = {};
+static portMUX_TYPE profileLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Indexed by I2CCommand
+static const char* const kCommandNames[I2C_COMMAND_COUNT] = {
+    "GetDataReady",
+    "ReadMeasuredValues",
+    "ReadRawValues",
+    "ReadNumberConc",
+    "ReadDeviceStatus",
+    "DeviceReset",
+    "SetTempAcceleration",
+    "SetTempOffset",
+    "SetAltitude",
+    "StartMeasurement",
+    "StopMeasurement",
+    "ForcedRecalibration",
+    "FanCleaning",
+    "ShtHeater",
+    "GetSerialNumber",
+    "GetVocState",
+    "SetVocState"
+};
+
+static uint8_t bucket_of(uint32_t us) {
+    // Bucket n holds [FIRST << (n - 1), FIRST << n), found from the bit length of us / FIRST
+    uint32_t scaled = us / I2C_PROFILER_FIRST_BUCKET_US;
+    uint8_t bucket = 0;
+    while (scaled != 0 && bucket < I2C_PROFILER_BUCKETS - 1) {
+        scaled >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void i2c_profiler_record(uint8_t sensorId, I2CCommand command, uint32_t us, bool error) {
+    if (sensorId >= SENSOR_COUNT) {
+        return;
+    }
+    I2CCommandProfile& profile = profiles[sensorId][static_cast<uint8_t>(command)];
+    uint8_t bucket = bucket_of(us);
+
+    portENTER_CRITICAL(&profileLock);
+    profile.count++;
+    if (error) {
+        profile.errors++;
+    }
+    if (us > profile.maxUs) {
+        profile.maxUs = us;
+    }
+    profile.totalUs += us;
+    profile.buckets[bucket]++;
+    portEXIT_CRITICAL(&profileLock);
+}
+
+void i2c_profiler_get(uint8_t sensorId, I2CCommand command, I2CCommandProfile* profile) {
+    if (sensorId >= SENSOR_COUNT) {
+        *profile = {};
+        return;
+    }
+    portENTER_CRITICAL(&profileLock);
+    *profile = profiles[sensorId][static_cast<uint8_t>(command)];
+    portEXIT_CRITICAL(&profileLock);
+}
+
+void i2c_profiler_reset() {
+    portENTER_CRITICAL(&profileLock);
+    memset(profiles, 0, sizeof(profiles));
+    portEXIT_CRITICAL(&profileLock);
+}
+
+const char* i2c_command_name(I2CCommand command) {
+    return static_cast<uint8_t>(command) < I2C_COMMAND_COUNT ? kCommandNames[static_cast<uint8_t>(command)] : "?";
+}
+
+uint32_t i2c_profiler_bucket_limit(uint8_t bucket) {
+    return bucket + 1 < I2C_PROFILER_BUCKETS ? static_cast<uint32_t>(I2C_PROFILER_FIRST_BUCKET_US) << bucket : UINT32_MAX;
+}
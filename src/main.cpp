@@ -7,6 +7,7 @@
 #include "tasks/serial_logging_task.h"
 #include "tasks/i2c_scan_task.h"
 #include "tasks/live_data_manager.h"
+#include "tasks/history_store.h"
 #include "tasks/display_task.h"
 #include "tasks/button_handler.h"
 #include "definitions.h"
@@ -14,6 +15,9 @@
 // Global variables
 TaskHandle_t xSerialLogTaskHandle = nullptr;
 TaskHandle_t xI2CScanTaskHandle = nullptr;
+#if SENSOR_COUNT > 1
+TaskHandle_t xI2CScanTask1Handle = nullptr;
+#endif
 
 void disableWireless() {
     // Disable WiFi
@@ -45,17 +49,18 @@ void setup() {
     pinMode(PIN_POWER_ON, OUTPUT);
     digitalWrite(PIN_POWER_ON, 1);
     
-    // Launch LiveDataManager task first
-    if (launchTaskWithVerification(
-        LiveDataManager::liveDataManagerTask,
-        LIVE_DATA_TASK_NAME,
-        LIVE_DATA_STACK_SIZE,
-        nullptr,
-        TIER_I_PRIORITY,
-        &LiveDataManager::xLiveDataManagerTaskHandle
-    ) != pdPASS) {
-        Serial.println("Failed to create LiveDataManager task");
-        while (1) delay(100);
+    // Locate the history partition before the display task restores the charts from it
+    if (HistoryStore::getInstance().begin()) {
+        if (launchTaskWithVerification(
+            HistoryStore::historyStoreTask,
+            HISTORY_TASK_NAME,
+            DEFAULT_STACK_SIZE,
+            nullptr,
+            TIER_III_PRIORITY,
+            &HistoryStore::xHistoryStoreTaskHandle
+        ) != pdPASS) {
+            Serial.println("Failed to create history store task");
+        }
     }
     
     // Launch I2C scan task
@@ -63,13 +68,27 @@ void setup() {
         I2CScanTask::i2cScanTask,
         I2C_SCAN_TASK_NAME,
         I2C_STACK_SIZE,
-        nullptr,
+        &I2CScanTask::getInstance(0),
         TIER_II_PRIORITY,
         &xI2CScanTaskHandle
     ) != pdPASS) {
         Serial.println("Failed to create I2C scan task");
         while (1) delay(100);
     }
+
+    #if SENSOR_COUNT > 1
+    // Each bus gets its own task, a slow or missing second sensor never delays the first
+    if (launchTaskWithVerification(
+        I2CScanTask::i2cScanTask,
+        I2C_SCAN_TASK1_NAME,
+        I2C_STACK_SIZE,
+        &I2CScanTask::getInstance(1),
+        TIER_II_PRIORITY,
+        &xI2CScanTask1Handle
+    ) != pdPASS) {
+        Serial.println("Failed to create second I2C scan task");
+    }
+    #endif
     
     #ifdef SERIAL_LOGGING
     // Launch serial logging task
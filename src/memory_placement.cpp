@@ -0,0 +1,126 @@
+#include "memory_placement.h"
+#include <esp_heap_caps.h>
+#include <FreeRTOS.h>
+#if __has_include(<esp_memory_utils.h>)
+#include <esp_memory_utils.h>
+#else
+#include <soc/soc_memory_layout.h>
+#endif
+
+static memory_region_stats_t regionStats[MEMORY_REGION_COUNT] = {};
+static portMUX_TYPE statsLock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char* const kRegionNames[MEMORY_REGION_COUNT] = {
+    "LVGL",
+    "History"
+};
+
+static bool is_external(const void* ptr) {
+    return esp_ptr_external_ram(ptr);
+}
+
+static void account(memory_region_t region, void* ptr, int direction) {
+    size_t size = heap_caps_get_allocated_size(ptr);
+    memory_region_stats_t& stats = regionStats[region];
+
+    portENTER_CRITICAL(&statsLock);
+    if (direction > 0) {
+        stats.used += size;
+        stats.allocations++;
+        if (is_external(ptr)) {
+            stats.external += size;
+        }
+        if (stats.used > stats.peak) {
+            stats.peak = stats.used;
+        }
+    } else {
+        stats.used -= size;
+        stats.allocations--;
+        if (is_external(ptr)) {
+            stats.external -= size;
+        }
+    }
+    portEXIT_CRITICAL(&statsLock);
+}
+
+static void count_failure(memory_region_t region) {
+    portENTER_CRITICAL(&statsLock);
+    regionStats[region].failures++;
+    portEXIT_CRITICAL(&statsLock);
+}
+
+void* memory_alloc(memory_region_t region, size_t size) {
+    void* ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (ptr == nullptr) {
+        ptr = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (ptr == nullptr) {
+        count_failure(region);
+        return nullptr;
+    }
+    account(region, ptr, 1);
+    return ptr;
+}
+
+void memory_free(memory_region_t region, void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    account(region, ptr, -1);
+    heap_caps_free(ptr);
+}
+
+void* memory_realloc(memory_region_t region, void* ptr, size_t size) {
+    if (ptr == nullptr) {
+        return memory_alloc(region, size);
+    }
+    if (size == 0) {
+        memory_free(region, ptr);
+        return nullptr;
+    }
+
+    // The old block stays accounted until the resize is known to have succeeded
+    size_t oldSize = heap_caps_get_allocated_size(ptr);
+    bool oldExternal = is_external(ptr);
+    void* resized = heap_caps_realloc(ptr, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (resized == nullptr) {
+        resized = heap_caps_realloc(ptr, size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (resized == nullptr) {
+        count_failure(region);
+        return nullptr;
+    }
+
+    memory_region_stats_t& stats = regionStats[region];
+    portENTER_CRITICAL(&statsLock);
+    stats.used -= oldSize;
+    stats.allocations--;
+    if (oldExternal) {
+        stats.external -= oldSize;
+    }
+    portEXIT_CRITICAL(&statsLock);
+    account(region, resized, 1);
+    return resized;
+}
+
+void memory_region_get_stats(memory_region_t region, memory_region_stats_t* stats) {
+    portENTER_CRITICAL(&statsLock);
+    *stats = regionStats[region];
+    portEXIT_CRITICAL(&statsLock);
+}
+
+const char* memory_region_name(memory_region_t region) {
+    return region < MEMORY_REGION_COUNT ? kRegionNames[region] : "?";
+}
+
+void* lvgl_mem_alloc(size_t size) {
+    return memory_alloc(MEMORY_REGION_LVGL, size);
+}
+
+void lvgl_mem_free(void* ptr) {
+    memory_free(MEMORY_REGION_LVGL, ptr);
+}
+
+void* lvgl_mem_realloc(void* ptr, size_t size) {
+    return memory_realloc(MEMORY_REGION_LVGL, ptr, size);
+}
@@ -0,0 +1,155 @@
+#include "sen66_readout.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include <esp_timer.h>
+#include <SensirionErrors.h>
+#include "checksum.h"
+#include "i2c_profiler.h"
+
+// SEN66 read commands, see the datasheet's command overview
+#define SEN66_CMD_GET_DATA_READY            0x0202
+#define SEN66_CMD_READ_MEASURED_VALUES      0x0300
+#define SEN66_CMD_READ_NUMBER_CONCENTRATION 0x0316
+#define SEN66_CMD_READ_RAW_VALUES           0x0405
+
+// Response layout and schedule of one read group
+struct Sen66ReadGroupInfo {
+    uint16_t command;
+    I2CCommand profile;     // Profiler entry of the command
+    uint8_t words;
+    uint16_t interval;      // Read on every interval-th sample, starting with the first
+    void (*decode)(const uint16_t* words, SensorData& data);
+};
+
+static void decode_measured_values(const uint16_t* words, SensorData& data) {
+    // Keep the sensor's integers, the chart history is built from them
+    data.scaledPm1p0 = words[0];
+    data.scaledPm2p5 = words[1];
+    data.scaledPm4p0 = words[2];
+    data.scaledPm10p0 = words[3];
+    data.scaledHumidity = static_cast<int16_t>(words[4]);
+    data.scaledTemperature = static_cast<int16_t>(words[5]);
+    data.scaledVocIndex = static_cast<int16_t>(words[6]);
+    data.scaledNoxIndex = static_cast<int16_t>(words[7]);
+    data.scaledCo2 = words[8];
+
+    // The floats only divide the integers by the sensor's fixed scale factors
+    data.pm1p0 = data.scaledPm1p0 / 10.0f;
+    data.pm2p5 = data.scaledPm2p5 / 10.0f;
+    data.pm4p0 = data.scaledPm4p0 / 10.0f;
+    data.pm10p0 = data.scaledPm10p0 / 10.0f;
+    data.humidity = data.scaledHumidity / 100.0f;
+    data.temperature = data.scaledTemperature / 200.0f;
+    data.vocIndex = data.scaledVocIndex / 10.0f;
+    data.noxIndex = data.scaledNoxIndex / 10.0f;
+    data.co2 = data.scaledCo2;
+}
+
+static void decode_raw_values(const uint16_t* words, SensorData& data) {
+    data.rawHumidity = static_cast<int16_t>(words[0]);
+    data.rawTemperature = static_cast<int16_t>(words[1]);
+    data.rawVOC = words[2];
+    data.rawNOx = words[3];
+    data.rawCO2 = words[4];
+}
+
+static void decode_number_concentrations(const uint16_t* words, SensorData& data) {
+    data.numberConc0p5 = words[0];
+    data.numberConc1p0 = words[1];
+    data.numberConc2p5 = words[2];
+    data.numberConc4p0 = words[3];
+    data.numberConc10p0 = words[4];
+}
+
+// Indexed by Sen66ReadGroup
+static const Sen66ReadGroupInfo kReadGroups[SEN66_READ_GROUP_COUNT] = {
+    {SEN66_CMD_READ_MEASURED_VALUES, I2CCommand::ReadMeasuredValues, 9, 1, decode_measured_values},
+    {SEN66_CMD_READ_RAW_VALUES, I2CCommand::ReadRawValues, 5, SEN66_RAW_VALUES_INTERVAL, decode_raw_values},
+    {SEN66_CMD_READ_NUMBER_CONCENTRATION, I2CCommand::ReadNumberConcentrations, 5, SEN66_NUMBER_CONC_INTERVAL,
+     decode_number_concentrations}
+};
+
+void Sen66Readout::begin(TwoWire& wire, uint8_t address, uint8_t sensorId) {
+    _wire = &wire;
+    _address = address;
+    _sensorId = sensorId;
+}
+
+uint16_t Sen66Readout::readWords(uint16_t command, I2CCommand profile, uint16_t* words, uint8_t count,
+                                 Sen66BusCounters& counters) {
+    int64_t start = esp_timer_get_time();
+    uint16_t error = transferWords(command, words, count, counters);
+    i2c_profiler_record(_sensorId, profile, static_cast<uint32_t>(esp_timer_get_time() - start), error != 0);
+    return error;
+}
+
+uint16_t Sen66Readout::transferWords(uint16_t command, uint16_t* words, uint8_t count, Sen66BusCounters& counters) {
+    const uint8_t length = count * 3;
+    uint8_t response[SEN66_MAX_RESPONSE_WORDS * 3];
+
+    int64_t start = esp_timer_get_time();
+    _wire->beginTransmission(_address);
+    _wire->write(static_cast<uint8_t>(command >> 8));
+    _wire->write(static_cast<uint8_t>(command & 0xFF));
+    uint8_t result = _wire->endTransmission();
+    counters.busUs += esp_timer_get_time() - start;
+    counters.transactions++;
+    counters.bytes += 3;
+    if (result != 0) {
+        // Same mapping of Wire's status codes as the Sensirion driver
+        uint16_t lowLevel = result == 2 ? LowLevelError::I2cAddressNack
+                          : result == 3 ? LowLevelError::I2cDataNack
+                                        : LowLevelError::I2cOtherError;
+        return HighLevelError::WriteError | lowLevel;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(SEN66_COMMAND_EXECUTION_TIME));
+
+    start = esp_timer_get_time();
+    uint8_t received = _wire->requestFrom(_address, length);
+    received = _wire->readBytes(response, received);
+    counters.busUs += esp_timer_get_time() - start;
+    counters.transactions++;
+    counters.bytes += 1 + received;
+    if (received < length) {
+        return HighLevelError::ReadError | LowLevelError::NotEnoughDataError;
+    }
+
+    // One pass: check each word against its CRC while assembling it
+    for (uint8_t i = 0; i < count; i++) {
+        const uint8_t* word = &response[i * 3];
+        if (crc8_sensirion(word, 2) != word[2]) {
+            counters.crcErrors++;
+            return HighLevelError::ReadError | LowLevelError::CRCError;
+        }
+        words[i] = static_cast<uint16_t>(word[0] << 8 | word[1]);
+    }
+    return 0;
+}
+
+uint16_t Sen66Readout::readDataReady(bool& ready, Sen66BusCounters& counters) {
+    uint16_t word = 0;
+    uint16_t error = readWords(SEN66_CMD_GET_DATA_READY, I2CCommand::GetDataReady, &word, 1, counters);
+    // High byte is padding, the low byte is the flag
+    ready = !error && (word & 0xFF) != 0;
+    return error;
+}
+
+uint16_t Sen66Readout::readSample(uint32_t sample, SensorData& data, Sen66BusCounters& counters) {
+    uint16_t words[SEN66_MAX_RESPONSE_WORDS];
+
+    // The groups due for this sample go out back-to-back, before the sensor's next sample is ready
+    for (uint8_t group = 0; group < SEN66_READ_GROUP_COUNT; group++) {
+        const Sen66ReadGroupInfo& info = kReadGroups[group];
+        if ((sample - 1) % info.interval != 0) {
+            continue;
+        }
+        uint16_t error = readWords(info.command, info.profile, words, info.words, counters);
+        if (error) {
+            return error;
+        }
+        info.decode(words, data);
+        counters.groupReads[group]++;
+    }
+    return 0;
+}
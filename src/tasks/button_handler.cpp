@@ -1,4 +1,5 @@
 #include "tasks/button_handler.h"
+#include "tasks/task_utils.h"
 
 // Initialize static member
 TaskHandle_t ButtonHandler::xButtonTaskHandle = nullptr;
@@ -33,28 +34,55 @@ ButtonHandler::ButtonHandler()
     buttonRight.setLongClickDetectedRetriggerable(false);
 }
 
+void IRAM_ATTR ButtonHandler::buttonEdgeISR() {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    if (xButtonTaskHandle != nullptr) {
+        vTaskNotifyGiveFromISR(xButtonTaskHandle, &higherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
+
 void ButtonHandler::buttonTask(void* parameter) {
     ButtonHandler& handler = getInstance();
-    
+
+    attachInterrupt(digitalPinToInterrupt(PIN_BUTTON_LEFT), buttonEdgeISR, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(PIN_BUTTON_RIGHT), buttonEdgeISR, CHANGE);
+
+    #ifdef DEBUG_MODE
+    TaskWakeupCounter wakeupCounter = {"ButtonTask", 0, millis()};
+    #endif
+
+    uint32_t lastActivity = millis();
     while (true) {
+        // Sleep until a pin changes, poll only while a press is in progress
+        bool active = handler.buttonLeft.isPressed() || handler.buttonRight.isPressed() ||
+                      (millis() - lastActivity) < kActiveHoldMs;
+        TickType_t wait = active ? pdMS_TO_TICKS(kActivePollIntervalMs) : portMAX_DELAY;
+        if (ulTaskNotifyTake(pdTRUE, wait) > 0) {
+            lastActivity = millis();
+        }
+
+        #ifdef DEBUG_MODE
+        countTaskWakeup(wakeupCounter);
+        #endif
+
         handler.buttonLeft.loop();
         handler.buttonRight.loop();
-        vTaskDelay(pdMS_TO_TICKS(5));
     }
 }
 
 void ButtonHandler::handleLeftButton(Button2& btn) {
-    DisplayTask::getInstance().handleLeftButtonPress();
+    DisplayTask::postInput(DisplayInput::LeftPress);
 }
 
 void ButtonHandler::handleRightButton(Button2& btn) {
-    DisplayTask::getInstance().handleRightButtonPress();
+    DisplayTask::postInput(DisplayInput::RightPress);
 }
 
 void ButtonHandler::handleLeftButtonLongPress(Button2& btn) {
-    DisplayTask::getInstance().handleLeftButtonLongPress();
+    DisplayTask::postInput(DisplayInput::LeftLongPress);
 }
 
 void ButtonHandler::handleRightButtonLongPress(Button2& btn) {
-    DisplayTask::getInstance().handleRightButtonLongPress();
+    DisplayTask::postInput(DisplayInput::RightLongPress);
 }
\ No newline at end of file
@@ -1,13 +1,29 @@
 #include "tasks/display_task.h"
 #include "tasks/live_data_manager.h"
 #include "tasks/i2c_scan_task.h"
+#include "tasks/task_utils.h"
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
+#include <new>
+#include <esp_timer.h>
+#include "memory_placement.h"
+#ifdef DISPLAY_BACKEND_I80_DMA
+#include <esp_heap_caps.h>
+#include <esp_lcd_panel_vendor.h>
+#endif
 
 // Initialize static member
 TaskHandle_t DisplayTask::xDisplayTaskHandle = nullptr;
 
-// Queue handle for receiving data
-static QueueHandle_t xDataQueue = nullptr;
+// Points of the level below per point of each history level. Levels 2 and 4 keep the
+// 24 second and 576 second points of the former mid-term and long-term charts.
+static const uint8_t kLevelRatios[HISTORY_LEVELS] = {1, 4, 6, 6, 4, 5, 6};
+
+// Chart window of each level: 150 points of 1s, 4s, 24s, 144s, 576s, 48min and 4.8h
+static const char* const kLevelWindowLabels[HISTORY_LEVELS] = {
+    "2min30", "10min", "60min", "6h", "24h", "5d", "30d"
+};
 
 // Initialize TFT display in constructor
 DisplayTask::DisplayTask() : tft(kScreenWidth, kScreenHeight) {}
@@ -19,155 +35,304 @@ DisplayTask& DisplayTask::getInstance() {
 
 void DisplayTask::displayTask(void* parameter) {
     auto& instance = getInstance();
+    if (!instance.allocate_buffers()) {
+        Serial.println("DisplayTask: Failed to allocate history buffers!");
+        vTaskDelete(NULL);
+        return;
+    }
     instance.init_display();
+    instance.restore_history();
+
+    instance.sensorResultQueue = xQueueCreate(kSensorResultQueueSize, sizeof(SensorCommandResult));
+    if (instance.sensorResultQueue == nullptr) {
+        Serial.println("DisplayTask: Failed to create sensor result queue!");
+    }
+    instance.inputQueue = xQueueCreate(kInputQueueSize, sizeof(DisplayInput));
+    if (instance.inputQueue == nullptr) {
+        Serial.println("DisplayTask: Failed to create input queue!");
+    }
     
     // Subscribe to LiveDataManager
-    if (!LiveDataManager::getInstance().subscribe(xTaskGetCurrentTaskHandle(), &xDataQueue)) {
+    auto& liveData = LiveDataManager::getInstance();
+    if (!liveData.subscribe(xTaskGetCurrentTaskHandle())) {
         Serial.println("DisplayTask: Failed to subscribe to LiveDataManager!");
         vTaskDelete(NULL);
         return;
     }
     
+    #ifdef DEBUG_MODE
+    TaskWakeupCounter wakeupCounter = {"DisplayTask", 0, millis()};
+    #endif
+
     QueueMessage message;
+    uint32_t lastSequence = liveData.latestSequence();
+    uint32_t waitMs = 0;
     while (true) {        
-        // Check for new sensor data
-        if (xQueueReceive(xDataQueue, &message, pdMS_TO_TICKS(QUEUE_TIMEOUT_MS)) == pdTRUE) {
-            const SensorData& data = message.data;
+        // Sleep until new data, user input or the next LVGL timer deadline, whichever comes first
+        uint32_t notifiedBits = 0;
+        xTaskNotifyWait(0, LIVE_DATA_NOTIFY_BIT | DISPLAY_INPUT_NOTIFY_BIT | DISPLAY_SENSOR_RESULT_NOTIFY_BIT,
+                        &notifiedBits, pdMS_TO_TICKS(waitMs));
+
+        #ifdef DEBUG_MODE
+        countTaskWakeup(wakeupCounter);
+        #endif
+
+        // Apply results of sensor commands
+        SensorCommandResult result;
+        while (instance.sensorResultQueue != nullptr && xQueueReceive(instance.sensorResultQueue, &result, 0) == pdTRUE) {
+            instance.handle_sensor_result(result);
+        }
+        if (instance.processing && millis() - instance.frcStartMs > kFRCTimeoutMs) {
+            instance.show_frc_result(false, 0);
+        }
+
+        // Button events, in the order they were pressed
+        DisplayInput input;
+        while (instance.inputQueue != nullptr && xQueueReceive(instance.inputQueue, &input, 0) == pdTRUE) {
+            instance.handle_input(input);
+        }
 
-            if (data.runtime_ticks == 1) {
-                // Initialize buffers to reset all values as the sensor just started
-                instance.init_buffers();
+        bool received = false;
+        while (liveData.readNext(lastSequence, message)) {
+            QueueMessage shown;
+            if (!instance.select_sample(message, shown)) {
+                continue;
             }
-            
-            // Update ring buffers with new data
-            instance.updateParameterBuffer(&instance.pm1_buffers, data.pm1p0);
-            instance.updateParameterBuffer(&instance.pm2p5_buffers, data.pm2p5);
-            instance.updateParameterBuffer(&instance.pm4_buffers, data.pm4p0);
-            instance.updateParameterBuffer(&instance.pm10_buffers, data.pm10p0);
-            instance.updateParameterBuffer(&instance.co2_buffers, data.co2);
-            instance.updateParameterBuffer(&instance.voc_buffers, data.vocIndex);
-            instance.updateParameterBuffer(&instance.nox_buffers, data.noxIndex);
-            instance.updateParameterBuffer(&instance.temp_buffers, data.temperature);
-            instance.updateParameterBuffer(&instance.rh_buffers, data.humidity);
-            
-            // Update chart series with new ring buffer values
-            instance.update_chart_series(ui_PMScreen_PMChart, instance.pm1_series, &instance.pm1_buffers,
-                                        instance.pm2p5_series, &instance.pm2p5_buffers,
-                                        instance.pm4_series, &instance.pm4_buffers,
-                                        instance.pm10_series, &instance.pm10_buffers);
-            instance.update_chart_series(ui_CO2Screen_CO2Chart, instance.co2_series, &instance.co2_buffers);
-            instance.update_chart_series(ui_VOCScreen_VOCChart, instance.voc_series, &instance.voc_buffers);
-            instance.update_chart_series(ui_NOxScreen_NOxChart, instance.nox_series, &instance.nox_buffers);
-            instance.update_chart_series(ui_TempScreen_TempChart, instance.temp_series, &instance.temp_buffers);
-            instance.update_chart_series(ui_RHScreen_RHChart, instance.rh_series, &instance.rh_buffers);
-            
-            // Update Main Screen tiles
-            instance.update_tile_value(ui_MainScreen_TilePM, data.pm2p5);    // PM2.5
-            instance.update_tile_value(ui_MainScreen_TileRH, data.humidity); // Relative Humidity
-            instance.update_tile_value(ui_MainScreen_TileT, data.temperature); // Temperature
-            instance.update_tile_value(ui_MainScreen_TileNOx, data.noxIndex); // NOx Index
-            instance.update_tile_value(ui_MainScreen_TileVOC, data.vocIndex); // VOC Index
-            instance.update_tile_value(ui_MainScreen_TileCO2, data.co2);     // CO2
-            
-            // Update PM Screen values
-            instance.update_value_text(ui_PMScreen_Value, data.pm1p0, PM_DECIMALS);   // PM1.0
-            instance.update_value_text(ui_PMScreen_Value1, data.pm2p5, PM_DECIMALS);  // PM2.5
-            instance.update_value_text(ui_PMScreen_Value2, data.pm4p0, PM_DECIMALS);  // PM4.0
-            instance.update_value_text(ui_PMScreen_Value3, data.pm10p0, PM_DECIMALS); // PM10.0
-            
-            // Update CO2 Screen value
-            instance.update_value_text(ui_CO2Screen_Value, data.co2, CO2_DECIMALS);
-            
-            // Update VOC Screen value
-            instance.update_value_text(ui_VOCScreen_Value, data.vocIndex, VOC_DECIMALS);
-            
-            // Update NOx Screen value
-            instance.update_value_text(ui_NOxScreen_Value, data.noxIndex, NOX_DECIMALS);
-            
-            // Update Temperature Screen value
-            instance.update_value_text(ui_TempScreen_Value, data.temperature, TEMP_DECIMALS);
-            
-            // Update RH Screen value
-            instance.update_value_text(ui_RHScreen_Value, data.humidity, RH_DECIMALS);
-            
-            // Update indicator states
-            instance.update_all_indicators(data);
+            const SensorData& data = shown.data;
+            received = true;
 
-            //Update Runtime on FRC Screen
-            if (data.runtime_ticks >= 120) {
-                lv_obj_clear_state(ui_FRCScreen_LabelRuntime, LV_STATE_USER_1);
-            } else {
-                lv_obj_add_state(ui_FRCScreen_LabelRuntime, LV_STATE_USER_1);
+            #ifdef DEBUG_MODE
+            if (data.quality & SAMPLE_QUALITY_RESTART) {
+                Serial.println("DisplayTask: sensor measurement restarted, keeping the history");
             }
-            lv_label_set_text_fmt(ui_FRCScreen_LabelRuntime, "%lu sec", data.runtime_ticks);
+            #endif
+
+            // Update ring buffers with new data, samples missed while the sensor
+            // restarted become gaps at their place in time
+            instance.ingest_sample(shown);
+
+            // Keep the latest sample so screens can pull it when they are loaded
+            instance.latestData = data;
+            instance.hasLatestData = true;
         }
 
-        // Handle LVGL tasks
-        lv_task_handler();
-        
-        vTaskDelay(pdMS_TO_TICKS(5));
+        if (received) {
+            // Only the visible screen is redrawn, hidden screens catch up in switchScreen
+            instance.refresh_active_screen();
+        }
+
+        // Handle LVGL tasks, the return value is the time until the next timer is due
+        waitMs = lv_timer_handler();
+        if (waitMs == LV_NO_TIMER_READY || waitMs > kMaxIdleWaitMs) {
+            waitMs = kMaxIdleWaitMs;
+        } else if (waitMs == 0) {
+            waitMs = 1;
+        }
+        instance.update_frame_rate();
+    }
+}
+
+void DisplayTask::handle_sensor_result(const SensorCommandResult& result) {
+    switch (result.type) {
+        case SensorCommandType::ForcedRecalibration:
+            if (!processing || frcPendingReplies == 0) {
+                break;
+            }
+            // Every sensor reports, the screen shows success only if all of them recalibrated
+            if (!result.success) {
+                frcFailed = true;
+            } else if (result.sensorId < frcCorrectionSensor) {
+                frcCorrection = result.value;
+                frcCorrectionSensor = result.sensorId;
+            }
+            if (--frcPendingReplies == 0) {
+                show_frc_result(!frcFailed, frcCorrection);
+            }
+            break;
+        default:
+            #ifdef DEBUG_MODE
+            Serial.printf("DisplayTask: sensor %u command %d %s\n", result.sensorId, static_cast<int>(result.type),
+                          result.success ? "done" : "failed");
+            #endif
+            break;
+    }
+}
+
+void DisplayTask::show_frc_result(bool success, int32_t correction) {
+    if (success) {
+        lv_label_set_text(ui_FRCScreen_Title, "FRC successful, CO2 value corrected by");
+        lv_label_set_text_fmt(ui_FRCScreen_TargetValue, "%d", correction);
+        lv_label_set_text(ui_FRCScreen_Unit, "ppm");
+    } else {
+        lv_label_set_text(ui_FRCScreen_TargetValue, "FRC failed");
+    }
+    frcconfirmed = true;
+    processing = false;
+}
+
+void DisplayTask::notify(uint32_t bits) {
+    if (xDisplayTaskHandle != nullptr) {
+        xTaskNotify(xDisplayTaskHandle, bits, eSetBits);
+    }
+}
+
+void DisplayTask::postInput(DisplayInput input) {
+    // Dropped until the display task is up, or when the queue is full of unhandled presses
+    QueueHandle_t queue = getInstance().inputQueue;
+    if (queue != nullptr && xQueueSend(queue, &input, 0) == pdTRUE) {
+        notify(DISPLAY_INPUT_NOTIFY_BIT);
+    }
+}
+
+void DisplayTask::handle_input(DisplayInput input) {
+    switch (input) {
+        case DisplayInput::LeftPress:
+            handleLeftButtonPress();
+            break;
+        case DisplayInput::RightPress:
+            handleRightButtonPress();
+            break;
+        case DisplayInput::LeftLongPress:
+            handleLeftButtonLongPress();
+            break;
+        case DisplayInput::RightLongPress:
+            handleRightButtonLongPress();
+            break;
     }
 }
 
 void DisplayTask::my_disp_flush(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p) {
+    auto& instance = getInstance();
+    if (lv_disp_flush_is_last(disp)) {
+        instance.frameCount++;
+    }
+
+#ifdef DISPLAY_BACKEND_I80_DMA
+    // Queue the DMA transfer and return, LVGL renders into the other buffer meanwhile.
+    // on_color_trans_done reports the buffer as free once the transfer has finished.
+    esp_lcd_panel_draw_bitmap(instance.panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, color_p);
+#else
     uint32_t w = (area->x2 - area->x1 + 1);
     uint32_t h = (area->y2 - area->y1 + 1);
 
-    auto& instance = getInstance();
     instance.tft.startWrite();
     instance.tft.setAddrWindow(area->x1, area->y1, w, h);
     instance.tft.pushColors((uint16_t*)&color_p->full, w * h, true);
     instance.tft.endWrite();
 
     lv_disp_flush_ready(disp);
+#endif
 }
 
-void DisplayTask::update_tile_value(lv_obj_t* tile, float value) {
-    char buffer[16];
-    
-    // Check for unknown values based on parameter type
-    bool is_unknown = false;
-    
-    if (tile == ui_MainScreen_TilePM) {
-        // PM2.5: Unknown if value is negative or exceeds MAX
-        is_unknown = (value < SensorThresholds::PM25::MIN || value > SensorThresholds::PM25::MAX);
-    } else if (tile == ui_MainScreen_TileCO2) {
-        // CO2: Unknown if value is negative or exceeds MAX
-        is_unknown = (value < SensorThresholds::CO2::MIN || value > SensorThresholds::CO2::MAX);
-    } else if (tile == ui_MainScreen_TileVOC) {
-        // VOC Index: Unknown if value is negative or exceeds MAX
-        is_unknown = (value < SensorThresholds::VOC::MIN || value > SensorThresholds::VOC::MAX);
-    } else if (tile == ui_MainScreen_TileNOx) {
-        // NOx Index: Unknown if value is negative or exceeds MAX
-        is_unknown = (value < SensorThresholds::NOx::MIN || value > SensorThresholds::NOx::MAX);
-    } else if (tile == ui_MainScreen_TileT) {
-        // Temperature: Unknown if value is outside MIN to MAX
-        is_unknown = (value < SensorThresholds::Temperature::MIN || value > SensorThresholds::Temperature::MAX);
-    } else if (tile == ui_MainScreen_TileRH) {
-        // Humidity: Unknown if value is outside MIN to MAX
-        is_unknown = (value < SensorThresholds::Humidity::MIN || value > SensorThresholds::Humidity::MAX);
+#ifdef DISPLAY_BACKEND_I80_DMA
+bool DisplayTask::on_color_trans_done(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t* edata, void* user_ctx) {
+    lv_disp_flush_ready(static_cast<lv_disp_drv_t*>(user_ctx));
+    return false;
+}
+
+bool DisplayTask::init_i80_panel(lv_disp_drv_t* disp_drv) {
+    // The read strobe is not used, keep it inactive
+    pinMode(PIN_LCD_RD, OUTPUT);
+    digitalWrite(PIN_LCD_RD, HIGH);
+
+    esp_lcd_i80_bus_handle_t i80_bus = nullptr;
+    esp_lcd_i80_bus_config_t bus_config = {};
+    bus_config.dc_gpio_num = PIN_LCD_DC;
+    bus_config.wr_gpio_num = PIN_LCD_WR;
+    bus_config.clk_src = LCD_CLK_SRC_PLL160M;
+    const int data_pins[8] = {PIN_LCD_D0, PIN_LCD_D1, PIN_LCD_D2, PIN_LCD_D3,
+                              PIN_LCD_D4, PIN_LCD_D5, PIN_LCD_D6, PIN_LCD_D7};
+    for (size_t i = 0; i < 8; i++) {
+        bus_config.data_gpio_nums[i] = data_pins[i];
+    }
+    bus_config.bus_width = 8;
+    bus_config.max_transfer_bytes = kBufferSize * sizeof(lv_color_t);
+    if (esp_lcd_new_i80_bus(&bus_config, &i80_bus) != ESP_OK) {
+        return false;
+    }
+
+    esp_lcd_panel_io_handle_t io_handle = nullptr;
+    esp_lcd_panel_io_i80_config_t io_config = {};
+    io_config.cs_gpio_num = PIN_LCD_CS;
+    io_config.pclk_hz = kI80PixelClockHz;
+    io_config.trans_queue_depth = kI80TransferQueueDepth;
+    io_config.on_color_trans_done = on_color_trans_done;
+    io_config.user_ctx = disp_drv;
+    io_config.lcd_cmd_bits = 8;
+    io_config.lcd_param_bits = 8;
+    io_config.dc_levels.dc_idle_level = 0;
+    io_config.dc_levels.dc_cmd_level = 0;
+    io_config.dc_levels.dc_dummy_level = 0;
+    io_config.dc_levels.dc_data_level = 1;
+    io_config.flags.swap_color_bytes = 1;  // The peripheral swaps RGB565 bytes, not the CPU
+    if (esp_lcd_new_panel_io_i80(i80_bus, &io_config, &io_handle) != ESP_OK) {
+        return false;
+    }
+
+    esp_lcd_panel_dev_config_t panel_config = {};
+    panel_config.reset_gpio_num = PIN_LCD_RES;
+    panel_config.color_space = ESP_LCD_COLOR_SPACE_RGB;
+    panel_config.bits_per_pixel = 16;
+    if (esp_lcd_new_panel_st7789(io_handle, &panel_config, &panel_handle) != ESP_OK) {
+        return false;
+    }
+    esp_lcd_panel_reset(panel_handle);
+    esp_lcd_panel_init(panel_handle);
+    esp_lcd_panel_invert_color(panel_handle, true);
+    esp_lcd_panel_set_gap(panel_handle, kPanelColumnOffset, 0);
+    esp_lcd_panel_disp_on_off(panel_handle, true);
+
+    // Two draw buffers so LVGL can render the next area while the previous one is transferred
+    for (auto& buffer : dma_buffers) {
+        buffer = static_cast<lv_color_t*>(heap_caps_malloc(kBufferSize * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL));
+        if (buffer == nullptr) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+void DisplayTask::update_frame_rate() {
+    uint32_t now = millis();
+    uint32_t elapsed = now - fpsWindowStart;
+    if (elapsed < kFpsWindowMs) {
+        return;
+    }
+
+    uint32_t frames = frameCount;
+    framesPerSecond = (frames - fpsWindowFrames) * 1000.0f / elapsed;
+    fpsWindowFrames = frames;
+    fpsWindowStart = now;
+
+    #ifdef DEBUG_MODE
+    if (framesPerSecond > 0.0f) {
+        Serial.printf("Display: %.1f fps\n", framesPerSecond);
     }
+    #endif
+}
+
+void DisplayTask::update_tile_value(lv_obj_t* tile, ParameterChannel channel, float value) {
+    const ParameterDescriptor& descriptor = parameter_descriptor(channel);
+    char buffer[16];
     
-    if (is_unknown) {
-        lv_label_set_text(ui_comp_get_child(tile, UI_COMP_TILE_VALUE), "-");
+    if (!parameter_is_valid(descriptor, value)) {
+        set_cached_text(tile_cache[static_cast<size_t>(channel)], ui_comp_get_child(tile, UI_COMP_TILE_VALUE), "-");
         return;
     }
     
-    // Special formatting for different measurements
-    if (tile == ui_MainScreen_TilePM && value >= 100.0f) {
-        // PM2.5 >= 100: show as integer
-        snprintf(buffer, sizeof(buffer), "%d", static_cast<int>(value));
-    } else if (tile == ui_MainScreen_TileNOx || 
-               tile == ui_MainScreen_TileVOC || 
-               tile == ui_MainScreen_TileCO2) {
-        // NOx, VOC, and CO2: always show as integer
+    // Large values drop their decimals to fit the tile
+    uint8_t decimals = descriptor.tileDecimals;
+    if (descriptor.integerAbove > 0.0f && value >= descriptor.integerAbove) {
+        decimals = 0;
+    }
+    if (decimals == 0) {
         snprintf(buffer, sizeof(buffer), "%d", static_cast<int>(value));
     } else {
-        // Default: show with one decimal place
-        snprintf(buffer, sizeof(buffer), "%.1f", value);
+        snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
     }
     
-    lv_label_set_text(ui_comp_get_child(tile, UI_COMP_TILE_VALUE), buffer);
+    set_cached_text(tile_cache[static_cast<size_t>(channel)], ui_comp_get_child(tile, UI_COMP_TILE_VALUE), buffer);
 }
 
 void DisplayTask::configure_chart_antialiasing(lv_obj_t* chart) {
@@ -177,226 +342,87 @@ void DisplayTask::configure_chart_antialiasing(lv_obj_t* chart) {
     lv_obj_set_style_line_opa(chart, LV_OPA_COVER, LV_PART_ITEMS);
     
     // Configure the chart for smoother rendering
+    // Shift mode draws each series from its x start point, which update_chart_series
+    // moves to the oldest point of the circular history buffer
     lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_SHIFT);
-    lv_chart_set_point_count(chart, 150);  // Original point count
+    lv_chart_set_point_count(chart, kRingBufferSize);
     
     // Add minimal padding to prevent lines from touching the edges
     lv_obj_set_style_pad_all(chart, 1, LV_PART_MAIN);
 }
 
+bool DisplayTask::allocate_buffers() {
+    void* memory = memory_alloc(MEMORY_REGION_HISTORY, PARAMETER_CHANNEL_COUNT * sizeof(ParameterBuffers));
+    if (memory == nullptr) {
+        return false;
+    }
+    parameter_buffers = static_cast<ParameterBuffers*>(memory);
+    for (size_t channel = 0; channel < PARAMETER_CHANNEL_COUNT; channel++) {
+        new (&parameter_buffers[channel]) ParameterBuffers();
+    }
+    return true;
+}
+
 void DisplayTask::init_buffers() {
     // Initialize all buffers
-    for (size_t i = 0; i < kRingBufferSize; i++) {
-        pm1_buffers.short_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        pm1_buffers.mid_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        pm1_buffers.long_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        pm2p5_buffers.short_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        pm2p5_buffers.mid_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        pm2p5_buffers.long_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        pm4_buffers.short_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        pm4_buffers.mid_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        pm4_buffers.long_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        pm10_buffers.short_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        pm10_buffers.mid_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        pm10_buffers.long_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        co2_buffers.short_term_ring_buffer[i] = LV_CHART_POINT_NONE;    
-        co2_buffers.mid_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        co2_buffers.long_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        voc_buffers.short_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        voc_buffers.mid_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        voc_buffers.long_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        nox_buffers.short_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        nox_buffers.mid_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        nox_buffers.long_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        temp_buffers.short_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        temp_buffers.mid_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        temp_buffers.long_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        rh_buffers.short_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        rh_buffers.mid_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-        rh_buffers.long_term_ring_buffer[i] = LV_CHART_POINT_NONE;
-    }
-    pm1_buffers.mid_term_sum = 0.0f;
-    pm1_buffers.mid_term_count = 0;
-    pm1_buffers.long_term_sum = 0.0f;
-    pm1_buffers.long_term_count = 0;
-    pm2p5_buffers.mid_term_sum = 0.0f;
-    pm2p5_buffers.mid_term_count = 0;
-    pm2p5_buffers.long_term_sum = 0.0f;
-    pm2p5_buffers.long_term_count = 0;
-    pm4_buffers.mid_term_sum = 0.0f;
-    pm4_buffers.mid_term_count = 0;
-    pm4_buffers.long_term_sum = 0.0f;
-    pm4_buffers.long_term_count = 0;
-    pm10_buffers.mid_term_sum = 0.0f;
-    pm10_buffers.mid_term_count = 0;
-    pm10_buffers.long_term_sum = 0.0f;
-    pm10_buffers.long_term_count = 0;
-    co2_buffers.mid_term_sum = 0.0f;
-    co2_buffers.mid_term_count = 0;
-    co2_buffers.long_term_sum = 0.0f;
-    co2_buffers.long_term_count = 0;
-    voc_buffers.mid_term_sum = 0.0f;
-    voc_buffers.mid_term_count = 0;
-    voc_buffers.long_term_sum = 0.0f;
-    voc_buffers.long_term_count = 0;
-    nox_buffers.mid_term_sum = 0.0f;
-    nox_buffers.mid_term_count = 0;
-    nox_buffers.long_term_sum = 0.0f;
-    nox_buffers.long_term_count = 0;
-    temp_buffers.mid_term_sum = 0.0f;
-    temp_buffers.mid_term_count = 0;
-    temp_buffers.long_term_sum = 0.0f;
-    temp_buffers.long_term_count = 0;
-    rh_buffers.mid_term_sum = 0.0f;
-    rh_buffers.mid_term_count = 0;
-    rh_buffers.long_term_sum = 0.0f;
-    rh_buffers.long_term_count = 0;
+    for (size_t channel = 0; channel < PARAMETER_CHANNEL_COUNT; channel++) {
+        clear_parameter_buffers(&parameter_buffers[channel]);
+    }
 }
 
-void DisplayTask::update_ring_buffer(lv_coord_t* buffer, float value) {
-    // Shift all values one position to the left
-    for (size_t i = 0; i < kRingBufferSize - 1; i++) {
-        buffer[i] = buffer[i + 1];
+void DisplayTask::clear_parameter_buffers(ParameterBuffers* buffers) {
+    for (HistoryTier& tier : buffers->levels) {
+        tier.clear();
     }
-    
-    float scaled_value = valid_value(buffer, value);
-    
-    // Add new value at the end, or LV_CHART_POINT_NONE if invalid
-    if (scaled_value != -1.0f){ // Valid value
-        buffer[kRingBufferSize - 1] = static_cast<lv_coord_t>(scaled_value);
-    }
-    else{ // Invalid value
-        buffer[kRingBufferSize - 1] = LV_CHART_POINT_NONE;
+    for (LevelAccumulator& accumulator : buffers->accumulators) {
+        accumulator = LevelAccumulator();
     }
 }
 
-float DisplayTask::valid_value(lv_coord_t* buffer, float value){
-    // Check for unknown values based on parameter type
-    float scaled_value = value;
-    
-    if (buffer == pm1_buffers.short_term_ring_buffer || buffer == pm2p5_buffers.short_term_ring_buffer || 
-        buffer == pm4_buffers.short_term_ring_buffer || buffer == pm10_buffers.short_term_ring_buffer) {
-        // PM values: Unknown if value is negative or exceeds MAX
-        if (value < SensorThresholds::PM25::MIN || value > SensorThresholds::PM25::MAX){
-            scaled_value = -1.0f;
-        }
-        else{
-            // Scale to maintain PM_DECIMALS decimal places
-            scaled_value = value * powf(10, PM_DECIMALS);
-        }
-    } else if (buffer == co2_buffers.short_term_ring_buffer) {
-        // CO2: Unknown if value is negative or exceeds MAX
-        if (value < SensorThresholds::CO2::MIN || value > SensorThresholds::CO2::MAX){
-            scaled_value = -1.0f;
-        }
-        else{
-            // Scale to maintain CO2_DECIMALS decimal places
-            scaled_value = value * powf(10, CO2_DECIMALS);
-        }
-    } else if (buffer == voc_buffers.short_term_ring_buffer) {
-        // VOC Index: Unknown if value is negative or exceeds MAX
-        if (value < SensorThresholds::VOC::MIN || value > SensorThresholds::VOC::MAX){
-            scaled_value = -1.0f;
-        }
-        else{
-            // Scale to maintain VOC_DECIMALS decimal places
-            scaled_value = value * powf(10, VOC_DECIMALS);
-        }
-    } else if (buffer == nox_buffers.short_term_ring_buffer) {
-        // NOx Index: Unknown if value is negative or exceeds MAX
-        if (value < SensorThresholds::NOx::MIN || value > SensorThresholds::NOx::MAX){
-            scaled_value = -1.0f;
-        }
-        else{
-            // Scale to maintain NOX_DECIMALS decimal places
-            scaled_value = value * powf(10, NOX_DECIMALS);
-        }
-    } else if (buffer == temp_buffers.short_term_ring_buffer) {
-        // Temperature: Unknown if value is outside MIN to MAX
-        if (value < SensorThresholds::Temperature::MIN || value > SensorThresholds::Temperature::MAX){
-            scaled_value = -1.0f;
-        }
-        else{
-            // Scale to maintain TEMP_DECIMALS decimal places
-            scaled_value = value * powf(10, TEMP_DECIMALS);
-        }
-    } else if (buffer == rh_buffers.short_term_ring_buffer) {
-        // Humidity: Unknown if value is outside MIN to MAX
-        if (value < SensorThresholds::Humidity::MIN || value > SensorThresholds::Humidity::MAX){
-            scaled_value = -1.0f;
-        }
-        else{
-            // Scale to maintain RH_DECIMALS decimal places
-            scaled_value = value * powf(10, RH_DECIMALS);
-        }
+DisplayTask::HistoryTier* DisplayTask::active_tier(ParameterBuffers* buffers) {
+    return &buffers->levels[currentChartLevel];
+}
+
+lv_coord_t DisplayTask::chart_point(ParameterChannel channel, const SensorData& data) {
+    const ParameterDescriptor& descriptor = parameter_descriptor(channel);
+    if (data.unusableChannels & parameter_channel_bit(channel)) {
+        return LV_CHART_POINT_NONE;
     }
-    return scaled_value;
+    return static_cast<lv_coord_t>(parameter_sensor_to_point(descriptor, data.*descriptor.sensorField));
 }
 
 // Helper function to calculate adaptive range for a chart
-void DisplayTask::calculate_adaptive_range(lv_obj_t* chart, lv_coord_t* buffer, 
-                                         float default_min, float default_max, float min_spread,
-                                         lv_coord_t* buffer2, lv_coord_t* buffer3, lv_coord_t* buffer4) {
+void DisplayTask::calculate_adaptive_range(lv_obj_t* chart, const ParameterDescriptor& descriptor,
+                                         lv_obj_t* min_label, lv_obj_t* max_label, const HistoryTier* tier,
+                                         const HistoryTier* tier2, const HistoryTier* tier3, const HistoryTier* tier4) {
     float min_val = 20000.0f;
     float max_val = -200.0f;
     bool has_valid_data = false;
 
-    // Calculate scaled minimum spread and decimals based on chart type
-    float scaled_min_spread = min_spread;
-    uint8_t decimals = 0;
-    if (chart == ui_PMScreen_PMChart) {
-        scaled_min_spread = min_spread * powf(10, PM_DECIMALS);
-        decimals = PM_DECIMALS;
-    } else if (chart == ui_CO2Screen_CO2Chart) {
-        scaled_min_spread = min_spread * powf(10, CO2_DECIMALS);
-        decimals = CO2_DECIMALS;
-    } else if (chart == ui_VOCScreen_VOCChart) {
-        scaled_min_spread = min_spread * powf(10, VOC_DECIMALS);
-        decimals = VOC_DECIMALS;
-    } else if (chart == ui_NOxScreen_NOxChart) {
-        scaled_min_spread = min_spread * powf(10, NOX_DECIMALS);
-        decimals = NOX_DECIMALS;
-    } else if (chart == ui_TempScreen_TempChart) {
-        scaled_min_spread = min_spread * powf(10, TEMP_DECIMALS);
-        decimals = TEMP_DECIMALS;
-    } else if (chart == ui_RHScreen_RHChart) {
-        scaled_min_spread = min_spread * powf(10, RH_DECIMALS);
-        decimals = RH_DECIMALS;
-    }
-
-    // Find min and max values in the buffer(s)
-    if (chart == ui_PMScreen_PMChart && buffer2 && buffer3 && buffer4) {
-        // For PM chart, check all four buffers
-        for (size_t i = 0; i < kRingBufferSize; i++) {
-            if (buffer[i] != LV_CHART_POINT_NONE) {
-                float val = static_cast<float>(buffer[i]);
-                min_val = std::min(min_val, val);
-                max_val = std::max(max_val, val);
-                has_valid_data = true;
-            }
-            if (buffer4[i] != LV_CHART_POINT_NONE) {
-                float val = static_cast<float>(buffer4[i]);
-                min_val = std::min(min_val, val);
-                max_val = std::max(max_val, val);
-                has_valid_data = true;
-            }
-        }
-    } else {
-        // For other charts, use the provided buffer
-        for (size_t i = 0; i < kRingBufferSize; i++) {
-            if (buffer[i] != LV_CHART_POINT_NONE) {
-                float val = static_cast<float>(buffer[i]);
-                min_val = std::min(min_val, val);
-                max_val = std::max(max_val, val);
-                has_valid_data = true;
-            }
+    // Chart points carry the channel's decimals, scale the minimum spread to match
+    const float scaled_min_spread = descriptor.chartMinSpread * descriptor.scale;
+    const uint8_t decimals = descriptor.decimals;
+
+    // Take the running min and max of the displayed tier(s)
+    lv_coord_t tier_min, tier_max;
+    if (tier->range(tier_min, tier_max)) {
+        min_val = static_cast<float>(tier_min);
+        max_val = static_cast<float>(tier_max);
+        has_valid_data = true;
+    }
+    if (tier2 && tier3 && tier4) {
+        // For PM chart, PM1.0 bounds the series from below and PM10 from above
+        if (tier4->range(tier_min, tier_max)) {
+            min_val = has_valid_data ? std::min(min_val, static_cast<float>(tier_min)) : static_cast<float>(tier_min);
+            max_val = has_valid_data ? std::max(max_val, static_cast<float>(tier_max)) : static_cast<float>(tier_max);
+            has_valid_data = true;
         }
     }
 
     // If no valid data, use default range (already scaled)
     if (!has_valid_data) {
-        min_val = default_min * powf(10, decimals);
-        max_val = default_max * powf(10, decimals);
+        min_val = descriptor.chartDefaultMin * descriptor.scale;
+        max_val = descriptor.chartDefaultMax * descriptor.scale;
     }
 
     // Ensure minimum spread while respecting the minimum value constraint
@@ -404,7 +430,7 @@ void DisplayTask::calculate_adaptive_range(lv_obj_t* chart, lv_coord_t* buffer,
         float center = (min_val + max_val) / 2.0f;
         min_val = center - scaled_min_spread / 2.0f;
         max_val = center + scaled_min_spread / 2.0f;
-        if (min_val < 0 and chart != ui_TempScreen_TempChart) {
+        if (min_val < 0 && !descriptor.chartAllowsNegative) {
             min_val = 0;
             max_val = scaled_min_spread;
         }
@@ -418,120 +444,86 @@ void DisplayTask::calculate_adaptive_range(lv_obj_t* chart, lv_coord_t* buffer,
     // Update the range labels with proper decimal scaling
     char min_buffer[16];
     char max_buffer[16];
-    float scale_factor = 1.0f / powf(10, decimals);
-    
-    snprintf(min_buffer, sizeof(min_buffer), "%.*f", decimals, min_val * scale_factor);
-    snprintf(max_buffer, sizeof(max_buffer), "%.*f", decimals, max_val * scale_factor);
-
-    // Update the appropriate labels based on chart type
-    if (chart == ui_PMScreen_PMChart) {
-        lv_label_set_text(pm_min_label, min_buffer);
-        lv_label_set_text(pm_max_label, max_buffer);
-    } else if (chart == ui_CO2Screen_CO2Chart) {
-        lv_label_set_text(co2_min_label, min_buffer);
-        lv_label_set_text(co2_max_label, max_buffer);
-    } else if (chart == ui_VOCScreen_VOCChart) {
-        lv_label_set_text(voc_min_label, min_buffer);
-        lv_label_set_text(voc_max_label, max_buffer);
-    } else if (chart == ui_NOxScreen_NOxChart) {
-        lv_label_set_text(nox_min_label, min_buffer);
-        lv_label_set_text(nox_max_label, max_buffer);
-    } else if (chart == ui_TempScreen_TempChart) {
-        lv_label_set_text(temp_min_label, min_buffer);
-        lv_label_set_text(temp_max_label, max_buffer);
-    } else if (chart == ui_RHScreen_RHChart) {
-        lv_label_set_text(rh_min_label, min_buffer);
-        lv_label_set_text(rh_max_label, max_buffer);
-    }
+    snprintf(min_buffer, sizeof(min_buffer), "%.*f", decimals, min_val * descriptor.inverseScale);
+    snprintf(max_buffer, sizeof(max_buffer), "%.*f", decimals, max_val * descriptor.inverseScale);
+    lv_label_set_text(min_label, min_buffer);
+    lv_label_set_text(max_label, max_buffer);
 }
 
-void DisplayTask::update_chart_series(lv_obj_t* chart, lv_chart_series_t* series, ParameterBuffers* buffer,
+void DisplayTask::update_chart_series(lv_obj_t* chart, ParameterChannel channel, lv_obj_t* min_label, lv_obj_t* max_label,
+                                    const EnvelopeSeries& envelope, lv_chart_series_t* series, ParameterBuffers* buffer,
                                     lv_chart_series_t* series2, ParameterBuffers* buffer2,
                                     lv_chart_series_t* series3, ParameterBuffers* buffer3,
                                     lv_chart_series_t* series4, ParameterBuffers* buffer4) {
     // Select the appropriate buffer based on current display mode
-    lv_coord_t* active_buffer;
-    lv_coord_t* active_buffer2 = nullptr;
-    lv_coord_t* active_buffer3 = nullptr;
-    lv_coord_t* active_buffer4 = nullptr;
-    
-    switch (currentDisplayMode) {
-        case ChartDisplayMode::ShortTerm:
-            active_buffer = buffer->short_term_ring_buffer;
-            if (chart == ui_PMScreen_PMChart && series2 && buffer2 && series3 && buffer3 && series4 && buffer4) {
-                active_buffer2 = buffer2->short_term_ring_buffer;
-                active_buffer3 = buffer3->short_term_ring_buffer;
-                active_buffer4 = buffer4->short_term_ring_buffer;
-            }
-            break;
-        case ChartDisplayMode::MidTerm:
-            active_buffer = buffer->mid_term_ring_buffer;
-            if (chart == ui_PMScreen_PMChart && series2 && buffer2 && series3 && buffer3 && series4 && buffer4) {
-                active_buffer2 = buffer2->mid_term_ring_buffer;
-                active_buffer3 = buffer3->mid_term_ring_buffer;
-                active_buffer4 = buffer4->mid_term_ring_buffer;
-            }
-            break;
-        case ChartDisplayMode::LongTerm:
-            active_buffer = buffer->long_term_ring_buffer;
-            if (chart == ui_PMScreen_PMChart && series2 && buffer2 && series3 && buffer3 && series4 && buffer4) {
-                active_buffer2 = buffer2->long_term_ring_buffer;
-                active_buffer3 = buffer3->long_term_ring_buffer;
-                active_buffer4 = buffer4->long_term_ring_buffer;
-            }
-            break;
-    }
+    const bool has_pm_series = series2 && buffer2 && series3 && buffer3 && series4 && buffer4;
+    HistoryTier* tier = active_tier(buffer);
+    HistoryTier* tier2 = has_pm_series ? active_tier(buffer2) : nullptr;
+    HistoryTier* tier3 = has_pm_series ? active_tier(buffer3) : nullptr;
+    HistoryTier* tier4 = has_pm_series ? active_tier(buffer4) : nullptr;
+    lv_coord_t* active_buffer = tier->points;
+    lv_coord_t* active_buffer2 = has_pm_series ? tier2->points : nullptr;
+    lv_coord_t* active_buffer3 = has_pm_series ? tier3->points : nullptr;
+    lv_coord_t* active_buffer4 = has_pm_series ? tier4->points : nullptr;
 
     // Update the chart range based on the buffer data
-    if (chart == ui_PMScreen_PMChart) {
-        calculate_adaptive_range(chart, active_buffer, 
-                               ChartRanges::PM::DEFAULT_MIN, 
-                               ChartRanges::PM::DEFAULT_MAX, 
-                               ChartRanges::PM::MIN_SPREAD,
-                               active_buffer2, active_buffer3, active_buffer4);
-    } else if (chart == ui_CO2Screen_CO2Chart) {
-        calculate_adaptive_range(chart, active_buffer, 
-                               ChartRanges::CO2::DEFAULT_MIN, 
-                               ChartRanges::CO2::DEFAULT_MAX, 
-                               ChartRanges::CO2::MIN_SPREAD);
-    } else if (chart == ui_VOCScreen_VOCChart) {
-        calculate_adaptive_range(chart, active_buffer, 
-                               ChartRanges::VOC::DEFAULT_MIN, 
-                               ChartRanges::VOC::DEFAULT_MAX, 
-                               ChartRanges::VOC::MIN_SPREAD);
-    } else if (chart == ui_NOxScreen_NOxChart) {
-        calculate_adaptive_range(chart, active_buffer, 
-                               ChartRanges::NOx::DEFAULT_MIN, 
-                               ChartRanges::NOx::DEFAULT_MAX, 
-                               ChartRanges::NOx::MIN_SPREAD);
-    } else if (chart == ui_TempScreen_TempChart) {
-        calculate_adaptive_range(chart, active_buffer, 
-                               ChartRanges::Temperature::DEFAULT_MIN, 
-                               ChartRanges::Temperature::DEFAULT_MAX, 
-                               ChartRanges::Temperature::MIN_SPREAD);
-    } else if (chart == ui_RHScreen_RHChart) {
-        calculate_adaptive_range(chart, active_buffer, 
-                               ChartRanges::Humidity::DEFAULT_MIN, 
-                               ChartRanges::Humidity::DEFAULT_MAX, 
-                               ChartRanges::Humidity::MIN_SPREAD);
-    }
-
-    // Update the chart series with the selected buffer
+    calculate_adaptive_range(chart, parameter_descriptor(channel), min_label, max_label,
+                             tier, tier2, tier3, tier4);
+
+    // Update the chart series with the selected buffer. The start point has to be
+    // set first, as setting the external array is what invalidates the chart.
+    lv_chart_set_x_start_point(chart, series, tier->head);
     lv_chart_set_ext_y_array(chart, series, active_buffer);
-    if (chart == ui_PMScreen_PMChart && series2 && buffer2 && series3 && buffer3 && series4 && buffer4) {
+    if (has_pm_series) {
+        lv_chart_set_x_start_point(chart, series2, tier2->head);
+        lv_chart_set_x_start_point(chart, series3, tier3->head);
+        lv_chart_set_x_start_point(chart, series4, tier4->head);
         lv_chart_set_ext_y_array(chart, series2, active_buffer2);
         lv_chart_set_ext_y_array(chart, series3, active_buffer3);
         lv_chart_set_ext_y_array(chart, series4, active_buffer4);
     }
+    update_envelope_series(chart, envelope, channel_buffers(channel));
+}
+
+DisplayTask::EnvelopeSeries DisplayTask::add_envelope_series(lv_obj_t* chart, lv_color_t color) {
+    EnvelopeSeries envelope;
+    envelope.min_series = lv_chart_add_series(chart, color, LV_CHART_AXIS_PRIMARY_Y);
+    envelope.max_series = lv_chart_add_series(chart, color, LV_CHART_AXIS_PRIMARY_Y);
+    return envelope;
+}
+
+void DisplayTask::update_envelope_series(lv_obj_t* chart, const EnvelopeSeries& envelope, ParameterBuffers* buffer) {
+    const bool visible = currentChartLevel > 0;
+    lv_chart_hide_series(chart, envelope.min_series, !visible);
+    lv_chart_hide_series(chart, envelope.max_series, !visible);
+    if (!visible) {
+        return;
+    }
+
+    HistoryTier* tier = active_tier(buffer);
+    lv_chart_set_x_start_point(chart, envelope.min_series, tier->head);
+    lv_chart_set_x_start_point(chart, envelope.max_series, tier->head);
+    lv_chart_set_ext_y_array(chart, envelope.min_series, tier->min_points);
+    lv_chart_set_ext_y_array(chart, envelope.max_series, tier->max_points);
 }
 
 void DisplayTask::init_display() {
     // Initialize LVGL
     lv_init();
 
+    static lv_disp_drv_t disp_drv;
+    lv_disp_drv_init(&disp_drv);
+
+#ifdef DISPLAY_BACKEND_I80_DMA
+    // Initialize the panel on the i80 LCD peripheral
+    if (!init_i80_panel(&disp_drv)) {
+        Serial.println("DisplayTask: Failed to initialize i80 display!");
+    }
+#else
     // Initialize TFT display
     tft.begin();
     tft.setRotation(0); // Portrait orientation
+#endif
 
     // Initialize LEDC PWM for backlight control
     ledcSetup(kLEDCChannel, kLEDCFrequency, kLEDCResolution);
@@ -540,11 +532,13 @@ void DisplayTask::init_display() {
     ledcWrite(kLEDCChannel, 255);
 
     // Initialize display buffer
+#ifdef DISPLAY_BACKEND_I80_DMA
+    lv_disp_draw_buf_init(&draw_buf, dma_buffers[0], dma_buffers[1], kBufferSize);
+#else
     lv_disp_draw_buf_init(&draw_buf, display_buffer, NULL, kBufferSize);
+#endif
 
     // Initialize display driver
-    static lv_disp_drv_t disp_drv;
-    lv_disp_drv_init(&disp_drv);
     disp_drv.hor_res = kScreenWidth;
     disp_drv.ver_res = kScreenHeight;
     disp_drv.flush_cb = my_disp_flush;
@@ -596,7 +590,15 @@ void DisplayTask::init_display() {
     configure_chart_antialiasing(ui_TempScreen_TempChart);
     configure_chart_antialiasing(ui_RHScreen_RHChart);
 
-    // Initialize chart series with ring buffers
+    // Initialize chart series with ring buffers. Series are drawn in the order they are
+    // added, the min/max envelopes come first so the means are drawn on top of them.
+    pm_envelope = add_envelope_series(ui_PMScreen_PMChart, lv_color_hex(0x77244E));
+    co2_envelope = add_envelope_series(ui_CO2Screen_CO2Chart, lv_color_hex(0x1D417B));
+    voc_envelope = add_envelope_series(ui_VOCScreen_VOCChart, lv_color_hex(0x1D417B));
+    nox_envelope = add_envelope_series(ui_NOxScreen_NOxChart, lv_color_hex(0x1D417B));
+    temp_envelope = add_envelope_series(ui_TempScreen_TempChart, lv_color_hex(0x1D417B));
+    rh_envelope = add_envelope_series(ui_RHScreen_RHChart, lv_color_hex(0x1D417B));
+
     // PM Chart - 4 series for different PM sizes
     pm1_series = lv_chart_add_series(ui_PMScreen_PMChart, lv_color_hex(0x3981F6), LV_CHART_AXIS_PRIMARY_Y);
     pm2p5_series = lv_chart_add_series(ui_PMScreen_PMChart, lv_color_hex(0xEE489C), LV_CHART_AXIS_PRIMARY_Y);
@@ -625,22 +627,73 @@ void DisplayTask::init_display() {
     rh_max_label = ui_RHScreen_YMaxValue;
 
     // Update all chart series with initial ring buffer values
-    update_chart_series(ui_PMScreen_PMChart, pm1_series, &pm1_buffers,
-                                pm2p5_series, &pm2p5_buffers,
-                                pm4_series, &pm4_buffers,
-                                pm10_series, &pm10_buffers);
-    update_chart_series(ui_CO2Screen_CO2Chart, co2_series, &co2_buffers);
-    update_chart_series(ui_VOCScreen_VOCChart, voc_series, &voc_buffers);
-    update_chart_series(ui_NOxScreen_NOxChart, nox_series, &nox_buffers);
-    update_chart_series(ui_TempScreen_TempChart, temp_series, &temp_buffers);
-    update_chart_series(ui_RHScreen_RHChart, rh_series, &rh_buffers);
-
-    // Set Chart Time Screen to Short Term
-    currentDisplayMode = ChartDisplayMode::ShortTerm;
-    lv_obj_clear_state(ui_ChartTimeScreen_CheckboxShort, LV_STATE_CHECKED);
-    lv_obj_clear_state(ui_ChartTimeScreen_CheckboxMedium, LV_STATE_CHECKED);
-    lv_obj_clear_state(ui_ChartTimeScreen_CheckboxLong, LV_STATE_CHECKED);
-    lv_obj_add_state(ui_ChartTimeScreen_CheckboxShort, LV_STATE_CHECKED);
+    update_chart_series(ui_PMScreen_PMChart, ParameterChannel::PM2p5, pm_min_label, pm_max_label, pm_envelope,
+                        pm1_series, channel_buffers(ParameterChannel::PM1p0),
+                        pm2p5_series, channel_buffers(ParameterChannel::PM2p5),
+                        pm4_series, channel_buffers(ParameterChannel::PM4p0),
+                        pm10_series, channel_buffers(ParameterChannel::PM10p0));
+    update_chart_series(ui_CO2Screen_CO2Chart, ParameterChannel::CO2, co2_min_label, co2_max_label, co2_envelope,
+                        co2_series, channel_buffers(ParameterChannel::CO2));
+    update_chart_series(ui_VOCScreen_VOCChart, ParameterChannel::VOC, voc_min_label, voc_max_label, voc_envelope,
+                        voc_series, channel_buffers(ParameterChannel::VOC));
+    update_chart_series(ui_NOxScreen_NOxChart, ParameterChannel::NOx, nox_min_label, nox_max_label, nox_envelope,
+                        nox_series, channel_buffers(ParameterChannel::NOx));
+    update_chart_series(ui_TempScreen_TempChart, ParameterChannel::Temperature, temp_min_label, temp_max_label, temp_envelope,
+                        temp_series, channel_buffers(ParameterChannel::Temperature));
+    update_chart_series(ui_RHScreen_RHChart, ParameterChannel::Humidity, rh_min_label, rh_max_label, rh_envelope,
+                        rh_series, channel_buffers(ParameterChannel::Humidity));
+
+    // Set Chart Time Screen to the shortest window
+    create_chart_window_checkboxes();
+    set_chart_level(0);
+}
+
+void DisplayTask::create_chart_window_checkboxes() {
+    // The generated screen only has the 2min30, 60min and 24h windows
+    chart_window_checkboxes[0] = ui_ChartTimeScreen_CheckboxShort;
+    chart_window_checkboxes[2] = ui_ChartTimeScreen_CheckboxMedium;
+    chart_window_checkboxes[4] = ui_ChartTimeScreen_CheckboxLong;
+
+    for (uint8_t level = 0; level < HISTORY_LEVELS; level++) {
+        lv_obj_t* checkbox = chart_window_checkboxes[level];
+        if (checkbox == nullptr) {
+            // Same look as the generated checkboxes
+            checkbox = lv_checkbox_create(ui_ChartTimeScreen_Panel);
+            lv_checkbox_set_text(checkbox, kLevelWindowLabels[level]);
+            lv_obj_set_height(checkbox, LV_SIZE_CONTENT);
+            lv_obj_set_align(checkbox, LV_ALIGN_CENTER);
+            lv_obj_add_flag(checkbox, LV_OBJ_FLAG_SCROLL_ON_FOCUS);
+            lv_obj_set_style_radius(checkbox, 10, LV_PART_INDICATOR | LV_STATE_DEFAULT);
+            lv_obj_set_style_radius(checkbox, 10, LV_PART_INDICATOR | LV_STATE_CHECKED);
+            ui_object_set_themeable_style_property(checkbox, LV_PART_INDICATOR | LV_STATE_CHECKED,
+                                                   LV_STYLE_BG_COLOR, _ui_theme_color_Green);
+            ui_object_set_themeable_style_property(checkbox, LV_PART_INDICATOR | LV_STATE_CHECKED,
+                                                   LV_STYLE_BG_OPA, _ui_theme_alpha_Green);
+            lv_obj_set_style_border_width(checkbox, 0, LV_PART_INDICATOR | LV_STATE_CHECKED);
+            chart_window_checkboxes[level] = checkbox;
+        }
+
+        // Two columns in level order, after the title
+        lv_obj_clear_state(checkbox, LV_STATE_CHECKED);
+        lv_obj_set_width(checkbox, lv_pct(50));
+        lv_obj_move_to_index(checkbox, level + 1);
+    }
+    lv_obj_set_style_pad_column(ui_ChartTimeScreen_Panel, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+}
+
+void DisplayTask::set_chart_level(uint8_t level) {
+    lv_obj_clear_state(chart_window_checkboxes[currentChartLevel], LV_STATE_CHECKED);
+    currentChartLevel = level;
+    lv_obj_add_state(chart_window_checkboxes[currentChartLevel], LV_STATE_CHECKED);
+
+    char label[16];
+    snprintf(label, sizeof(label), "-%s", kLevelWindowLabels[level]);
+    lv_label_set_text(ui_PMScreen_XMinValue, label);
+    lv_label_set_text(ui_CO2Screen_XMinValue, label);
+    lv_label_set_text(ui_VOCScreen_XMinValue, label);
+    lv_label_set_text(ui_NOxScreen_XMinValue, label);
+    lv_label_set_text(ui_TempScreen_XMinValue, label);
+    lv_label_set_text(ui_RHScreen_XMinValue, label);
 }
 
 void DisplayTask::update_indicator_state(lv_obj_t* tile, IndicatorState state) {
@@ -670,68 +723,40 @@ void DisplayTask::update_indicator_state(lv_obj_t* tile, IndicatorState state) {
     }
 }
 
-void DisplayTask::update_all_indicators(const SensorData& data) {
-    // Temperature thresholds
-    if (data.temperature < SensorThresholds::Temperature::BLUE_MAX) {
-        update_indicator_state(ui_MainScreen_TileT, IndicatorState::Blue);
-    } else if (data.temperature <= SensorThresholds::Temperature::GREEN_MAX) {
-        update_indicator_state(ui_MainScreen_TileT, IndicatorState::Green);
-    } else {
-        update_indicator_state(ui_MainScreen_TileT, IndicatorState::Red);
-    }
-
-    // Humidity thresholds
-    if (data.humidity >= SensorThresholds::Humidity::GREEN_MIN && 
-        data.humidity <= SensorThresholds::Humidity::GREEN_MAX) {
-        update_indicator_state(ui_MainScreen_TileRH, IndicatorState::Green);
-    } else if ((data.humidity >= SensorThresholds::Humidity::ORANGE_MIN && 
-                data.humidity < SensorThresholds::Humidity::GREEN_MIN) || 
-               (data.humidity > SensorThresholds::Humidity::GREEN_MAX && 
-                data.humidity <= SensorThresholds::Humidity::ORANGE_MAX)) {
-        update_indicator_state(ui_MainScreen_TileRH, IndicatorState::Orange);
-    } else {
-        update_indicator_state(ui_MainScreen_TileRH, IndicatorState::Red);
-    }
-
-    // CO2 thresholds
-    if (data.co2 < SensorThresholds::CO2::BLUE_MAX) {
-        update_indicator_state(ui_MainScreen_TileCO2, IndicatorState::Blue);
-    } else if (data.co2 < SensorThresholds::CO2::GREEN_MAX) {
-        update_indicator_state(ui_MainScreen_TileCO2, IndicatorState::Green);
-    } else if (data.co2 <= SensorThresholds::CO2::ORANGE_MAX) {
-        update_indicator_state(ui_MainScreen_TileCO2, IndicatorState::Orange);
-    } else {
-        update_indicator_state(ui_MainScreen_TileCO2, IndicatorState::Red);
+void DisplayTask::update_tile_indicator(lv_obj_t* tile, ParameterChannel channel, float value) {
+    // Changing the indicator state restarts its style transition, skip it while the band holds
+    ColorBand band = parameter_color_band(parameter_descriptor(channel), value);
+    if (set_cached_band(tile_cache[static_cast<size_t>(channel)], band)) {
+        update_indicator_state(tile, band);
     }
+}
 
-    // VOC thresholds
-    if (data.vocIndex < SensorThresholds::VOC::BLUE_MAX) {
-        update_indicator_state(ui_MainScreen_TileVOC, IndicatorState::Blue);
-    } else if (data.vocIndex <= SensorThresholds::VOC::GREEN_MAX) {
-        update_indicator_state(ui_MainScreen_TileVOC, IndicatorState::Green);
-    } else if (data.vocIndex <= SensorThresholds::VOC::ORANGE_MAX) {
-        update_indicator_state(ui_MainScreen_TileVOC, IndicatorState::Orange);
-    } else {
-        update_indicator_state(ui_MainScreen_TileVOC, IndicatorState::Red);
-    }
+void DisplayTask::update_all_indicators(const SensorData& data) {
+    update_tile_indicator(ui_MainScreen_TileT, ParameterChannel::Temperature, data.temperature);
+    update_tile_indicator(ui_MainScreen_TileRH, ParameterChannel::Humidity, data.humidity);
+    update_tile_indicator(ui_MainScreen_TileCO2, ParameterChannel::CO2, data.co2);
+    update_tile_indicator(ui_MainScreen_TileVOC, ParameterChannel::VOC, data.vocIndex);
+    update_tile_indicator(ui_MainScreen_TileNOx, ParameterChannel::NOx, data.noxIndex);
+    update_tile_indicator(ui_MainScreen_TilePM, ParameterChannel::PM2p5, data.pm2p5);
+}
 
-    // NOx thresholds
-    if (data.noxIndex <= SensorThresholds::NOx::GREEN_MAX) {
-        update_indicator_state(ui_MainScreen_TileNOx, IndicatorState::Green);
-    } else if (data.noxIndex <= SensorThresholds::NOx::ORANGE_MAX) {
-        update_indicator_state(ui_MainScreen_TileNOx, IndicatorState::Orange);
-    } else {
-        update_indicator_state(ui_MainScreen_TileNOx, IndicatorState::Red);
+void DisplayTask::set_cached_text(WidgetCache& cache, lv_obj_t* label, const char* text) {
+    // lv_label_set_text invalidates the label even if the text is the same
+    if (strncmp(cache.text, text, sizeof(cache.text)) == 0) {
+        return;
     }
+    strncpy(cache.text, text, sizeof(cache.text) - 1);
+    cache.text[sizeof(cache.text) - 1] = '\0';
+    lv_label_set_text(label, text);
+}
 
-    // PM2.5 thresholds
-    if (data.pm2p5 < SensorThresholds::PM25::GREEN_MAX) {
-        update_indicator_state(ui_MainScreen_TilePM, IndicatorState::Green);
-    } else if (data.pm2p5 <= SensorThresholds::PM25::ORANGE_MAX) {
-        update_indicator_state(ui_MainScreen_TilePM, IndicatorState::Orange);
-    } else {
-        update_indicator_state(ui_MainScreen_TilePM, IndicatorState::Red);
+bool DisplayTask::set_cached_band(WidgetCache& cache, ColorBand band) {
+    if (cache.has_band && cache.band == band) {
+        return false;
     }
+    cache.band = band;
+    cache.has_band = true;
+    return true;
 }
 
 void DisplayTask::switchScreen(uint8_t screenIndex) {
@@ -778,117 +803,140 @@ void DisplayTask::switchScreen(uint8_t screenIndex) {
             currentState = ScreenState::MainScreen;
             break;
     }
+
+    // Hidden screens are not updated while new samples arrive, so pull the current state now
+    refresh_active_screen();
 }
 
-void DisplayTask::update_value_text(lv_obj_t* label, float value, uint8_t decimals) {
-    char buffer[16];
-    
-    // Check for unknown values
-    bool is_unknown = false;
-    
-    if (label == ui_PMScreen_Value || label == ui_PMScreen_Value1 || 
-        label == ui_PMScreen_Value2 || label == ui_PMScreen_Value3) {
-        // PM values: Unknown if value is negative or exceeds MAX
-        is_unknown = (value < SensorThresholds::PM25::MIN || value > SensorThresholds::PM25::MAX);
-    } else if (label == ui_CO2Screen_Value) {
-        // CO2: Unknown if value is negative or exceeds MAX
-        is_unknown = (value < SensorThresholds::CO2::MIN || value > SensorThresholds::CO2::MAX);
-    } else if (label == ui_VOCScreen_Value) {
-        // VOC Index: Unknown if value is negative or exceeds MAX
-        is_unknown = (value < SensorThresholds::VOC::MIN || value > SensorThresholds::VOC::MAX);
-    } else if (label == ui_NOxScreen_Value) {
-        // NOx Index: Unknown if value is negative or exceeds MAX
-        is_unknown = (value < SensorThresholds::NOx::MIN || value > SensorThresholds::NOx::MAX);
-    } else if (label == ui_TempScreen_Value) {
-        // Temperature: Unknown if value is outside MIN to MAX
-        is_unknown = (value < SensorThresholds::Temperature::MIN || value > SensorThresholds::Temperature::MAX);
-    } else if (label == ui_RHScreen_Value) {
-        // Humidity: Unknown if value is outside MIN to MAX
-        is_unknown = (value < SensorThresholds::Humidity::MIN || value > SensorThresholds::Humidity::MAX);
+void DisplayTask::refresh_active_screen() {
+    const SensorData& data = latestData;
+
+    switch (currentState) {
+        case ScreenState::MainScreen:
+            if (!hasLatestData) {
+                break;
+            }
+            // Update Main Screen tiles
+            update_tile_value(ui_MainScreen_TilePM, ParameterChannel::PM2p5, data.pm2p5);
+            update_tile_value(ui_MainScreen_TileRH, ParameterChannel::Humidity, data.humidity);
+            update_tile_value(ui_MainScreen_TileT, ParameterChannel::Temperature, data.temperature);
+            update_tile_value(ui_MainScreen_TileNOx, ParameterChannel::NOx, data.noxIndex);
+            update_tile_value(ui_MainScreen_TileVOC, ParameterChannel::VOC, data.vocIndex);
+            update_tile_value(ui_MainScreen_TileCO2, ParameterChannel::CO2, data.co2);
+
+            // Update indicator states
+            update_all_indicators(data);
+            break;
+
+        case ScreenState::PMScreen:
+            update_chart_series(ui_PMScreen_PMChart, ParameterChannel::PM2p5, pm_min_label, pm_max_label, pm_envelope,
+                                pm1_series, channel_buffers(ParameterChannel::PM1p0),
+                                pm2p5_series, channel_buffers(ParameterChannel::PM2p5),
+                                pm4_series, channel_buffers(ParameterChannel::PM4p0),
+                                pm10_series, channel_buffers(ParameterChannel::PM10p0));
+            if (hasLatestData) {
+                update_value_text(ui_PMScreen_Value, ParameterChannel::PM1p0, data.pm1p0);
+                update_value_text(ui_PMScreen_Value1, ParameterChannel::PM2p5, data.pm2p5);
+                update_value_text(ui_PMScreen_Value2, ParameterChannel::PM4p0, data.pm4p0);
+                update_value_text(ui_PMScreen_Value3, ParameterChannel::PM10p0, data.pm10p0);
+            }
+            break;
+
+        case ScreenState::CO2Screen:
+            update_chart_series(ui_CO2Screen_CO2Chart, ParameterChannel::CO2, co2_min_label, co2_max_label, co2_envelope,
+                                co2_series, channel_buffers(ParameterChannel::CO2));
+            if (hasLatestData) {
+                update_value_text(ui_CO2Screen_Value, ParameterChannel::CO2, data.co2);
+            }
+            break;
+
+        case ScreenState::VOCScreen:
+            update_chart_series(ui_VOCScreen_VOCChart, ParameterChannel::VOC, voc_min_label, voc_max_label, voc_envelope,
+                                voc_series, channel_buffers(ParameterChannel::VOC));
+            if (hasLatestData) {
+                update_value_text(ui_VOCScreen_Value, ParameterChannel::VOC, data.vocIndex);
+            }
+            break;
+
+        case ScreenState::NOxScreen:
+            update_chart_series(ui_NOxScreen_NOxChart, ParameterChannel::NOx, nox_min_label, nox_max_label, nox_envelope,
+                                nox_series, channel_buffers(ParameterChannel::NOx));
+            if (hasLatestData) {
+                update_value_text(ui_NOxScreen_Value, ParameterChannel::NOx, data.noxIndex);
+            }
+            break;
+
+        case ScreenState::TempScreen:
+            update_chart_series(ui_TempScreen_TempChart, ParameterChannel::Temperature, temp_min_label, temp_max_label, temp_envelope,
+                                temp_series, channel_buffers(ParameterChannel::Temperature));
+            if (hasLatestData) {
+                update_value_text(ui_TempScreen_Value, ParameterChannel::Temperature, data.temperature);
+            }
+            break;
+
+        case ScreenState::RHScreen:
+            update_chart_series(ui_RHScreen_RHChart, ParameterChannel::Humidity, rh_min_label, rh_max_label, rh_envelope,
+                                rh_series, channel_buffers(ParameterChannel::Humidity));
+            if (hasLatestData) {
+                update_value_text(ui_RHScreen_Value, ParameterChannel::Humidity, data.humidity);
+            }
+            break;
+
+        case ScreenState::FRCScreen:
+            if (!hasLatestData) {
+                break;
+            }
+            //Update Runtime on FRC Screen
+            if (data.runtime_ticks >= 120) {
+                lv_obj_clear_state(ui_FRCScreen_LabelRuntime, LV_STATE_USER_1);
+            } else {
+                lv_obj_add_state(ui_FRCScreen_LabelRuntime, LV_STATE_USER_1);
+            }
+            lv_label_set_text_fmt(ui_FRCScreen_LabelRuntime, "%lu sec", data.runtime_ticks);
+            break;
+
+        default:
+            // Settings screens show no live data
+            break;
     }
+}
+
+void DisplayTask::update_value_text(lv_obj_t* label, ParameterChannel channel, float value) {
+    const ParameterDescriptor& descriptor = parameter_descriptor(channel);
+    WidgetCache& cache = value_cache[static_cast<size_t>(channel)];
+    char buffer[16];
     
-    if (is_unknown) {
-        lv_label_set_text(label, "-");
+    if (!parameter_is_valid(descriptor, value)) {
+        set_cached_text(cache, label, "-");
         return;
     }
     
-    // Special formatting for different measurements
-    if ((label == ui_PMScreen_Value || label == ui_PMScreen_Value1 || 
-         label == ui_PMScreen_Value2 || label == ui_PMScreen_Value3) && value >= 100.0f) {
-        // PM >= 100: show as integer
+    // Large values drop their decimals to fit the label
+    uint8_t decimals = descriptor.decimals;
+    if (descriptor.integerAbove > 0.0f && value >= descriptor.integerAbove) {
+        decimals = 0;
+    }
+    if (decimals == 0) {
         snprintf(buffer, sizeof(buffer), "%d", static_cast<int>(value));
     } else {
-        // Default: show with decimals decimal place
         snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
     }
     
-    lv_label_set_text(label, buffer);
+    set_cached_text(cache, label, buffer);
     
-    // Set color based on thresholds
-    if (label == ui_PMScreen_Value || label == ui_PMScreen_Value1 || 
-        label == ui_PMScreen_Value2 || label == ui_PMScreen_Value3) {
-        // PM values
-        if (value < SensorThresholds::PM25::GREEN_MAX) {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Green);
-        } else if (value <= SensorThresholds::PM25::ORANGE_MAX) {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Orange);
-        } else {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Red);
-        }
-    } else if (label == ui_CO2Screen_Value) {
-        // CO2
-        if (value < SensorThresholds::CO2::BLUE_MAX) {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Blue);
-        } else if (value < SensorThresholds::CO2::GREEN_MAX) {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Green);
-        } else if (value <= SensorThresholds::CO2::ORANGE_MAX) {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Orange);
-        } else {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Red);
-        }
-    } else if (label == ui_VOCScreen_Value) {
-        // VOC
-        if (value < SensorThresholds::VOC::BLUE_MAX) {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Blue);
-        } else if (value <= SensorThresholds::VOC::GREEN_MAX) {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Green);
-        } else if (value <= SensorThresholds::VOC::ORANGE_MAX) {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Orange);
-        } else {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Red);
-        }
-    } else if (label == ui_NOxScreen_Value) {
-        // NOx
-        if (value <= SensorThresholds::NOx::GREEN_MAX) {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Green);
-        } else if (value <= SensorThresholds::NOx::ORANGE_MAX) {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Orange);
-        } else {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Red);
-        }
-    } else if (label == ui_TempScreen_Value) {
-        // Temperature
-        if (value < SensorThresholds::Temperature::BLUE_MAX) {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Blue);
-        } else if (value <= SensorThresholds::Temperature::GREEN_MAX) {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Green);
-        } else {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Red);
-        }
-    } else if (label == ui_RHScreen_Value) {
-        // Humidity
-        if (value >= SensorThresholds::Humidity::GREEN_MIN && 
-            value <= SensorThresholds::Humidity::GREEN_MAX) {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Green);
-        } else if ((value >= SensorThresholds::Humidity::ORANGE_MIN && 
-                    value < SensorThresholds::Humidity::GREEN_MIN) || 
-                   (value > SensorThresholds::Humidity::GREEN_MAX && 
-                    value <= SensorThresholds::Humidity::ORANGE_MAX)) {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Orange);
-        } else {
-            ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, _ui_theme_color_Red);
-        }
+    // Set color based on thresholds, the theme manager updates the label's registration in place
+    static const ui_theme_variable_t* const kBandColors[] = {
+        _ui_theme_color_Green,   // ColorBand::Green
+        _ui_theme_color_Orange,  // ColorBand::Orange
+        _ui_theme_color_Red,     // ColorBand::Red
+        _ui_theme_color_Blue     // ColorBand::Blue
+    };
+    ColorBand band = parameter_color_band(descriptor, value);
+    if (!set_cached_band(cache, band)) {
+        return;
     }
+    ui_object_set_themeable_style_property(label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR,
+                                           kBandColors[static_cast<size_t>(band)]);
 }
 
 void DisplayTask::handleLeftButtonPress() {
@@ -1213,21 +1261,25 @@ void DisplayTask::handleRightButtonLongPress() {
                 lv_label_set_text(ui_FRCScreen_Title, "\n");
                 lv_label_set_text(ui_FRCScreen_TargetValue, "applying...");
                 lv_label_set_text(ui_FRCScreen_Unit, "");
-                int16_t correction = I2CScanTask::getInstance().setFRCValue(savedFRCSetValue);
-                if (correction == -32768) {
-                    lv_label_set_text(ui_FRCScreen_TargetValue, "FRC failed");
-                } else {
-                    lv_label_set_text(ui_FRCScreen_Title, "FRC successful, CO2 value corrected by");
-                    lv_label_set_text_fmt(ui_FRCScreen_TargetValue, "%d", correction);
-                    lv_label_set_text(ui_FRCScreen_Unit, "ppm");
+
+                // The result arrives as a UI event, input stays responsive meanwhile
+                SensorCommand command = {SensorCommandType::ForcedRecalibration, savedFRCSetValue,
+                                         sensorResultQueue, xDisplayTaskHandle, DISPLAY_SENSOR_RESULT_NOTIFY_BIT};
+                frcStartMs = millis();
+                frcPendingReplies = I2CScanTask::submitCommandToAll(command);
+                frcFailed = frcPendingReplies < SENSOR_COUNT;
+                frcCorrection = 0;
+                frcCorrectionSensor = SENSOR_COUNT;
+                if (frcPendingReplies == 0) {
+                    show_frc_result(false, 0);
                 }
-                frcconfirmed = true;
-                processing = false;
                 break;
             }
             case ScreenState::AltitudeScreen: {
                 int32_t altitude = atoi(lv_label_get_text(ui_AltitudeScreen_TargetValue));
-                I2CScanTask::getInstance().setAltitude(altitude);
+                SensorCommand command = {SensorCommandType::SetAltitude, altitude,
+                                         sensorResultQueue, xDisplayTaskHandle, DISPLAY_SENSOR_RESULT_NOTIFY_BIT};
+                I2CScanTask::submitCommandToAll(command);
                 break;
             }
         }
@@ -1293,7 +1345,7 @@ void DisplayTask::enterSettingsMode() {
             
         case ScreenState::ChartTimeScreen: {
             // Save current checkbox states
-            savedChartDisplayMode = currentDisplayMode;
+            savedChartLevel = currentChartLevel;
             
             lv_img_set_src(ui_ChartTimeScreen_ImageUp, &ui_img_816914973);  // arrow-big-up.png
             lv_img_set_src(ui_ChartTimeScreen_ImageDown, &ui_img_810620936);  // arrow-big-down.png
@@ -1362,122 +1414,307 @@ void DisplayTask::exitSettingsMode() {
     }
 }
 
-void DisplayTask::updateParameterBuffer(ParameterBuffers* buffers, float value) {
-    // Update short-term buffer (150 points, 1 point per second)
-    update_ring_buffer(buffers->short_term_ring_buffer, value);
-    
-    // Accumulate 24 seconds average
-    float scaled_value = valid_value(buffers->short_term_ring_buffer, value);
-    if (scaled_value != -1.0f){
-        buffers->mid_term_sum += scaled_value;
-        buffers->mid_term_count++;
-    }
-    if (buffers->mid_term_count == kMidTermBufferSize) {
-        update_ring_buffer(buffers->mid_term_ring_buffer, buffers->mid_term_sum / kMidTermBufferSize);
-        // Accumulate 576 seconds average
-        buffers->long_term_sum += buffers->mid_term_sum / kMidTermBufferSize;
-        buffers->long_term_count++;
-        if (buffers->long_term_count == kLongTermBufferSize) {
-            update_ring_buffer(buffers->long_term_ring_buffer, buffers->long_term_sum / kLongTermBufferSize);
-            buffers->long_term_sum = 0.0f;
-            buffers->long_term_count = 0;
+bool DisplayTask::select_sample(const QueueMessage& message, QueueMessage& shown) {
+    const uint8_t source = message.data.sensorId < SENSOR_COUNT ? message.data.sensorId : 0;
+    sensorLatest[source] = message.data;
+    sensorLatestUs[source] = message.timestampUs;
+
+    #if SENSOR_CHART_SOURCE != SENSOR_CHART_AVERAGE
+    shown = message;
+    return source == SENSOR_CHART_SOURCE;
+    #elif SENSOR_COUNT == 1
+    shown = message;
+    return true;
+    #else
+    // A lower sensor that is still publishing drives the clock, this one only contributes
+    for (uint8_t id = 0; id < source; id++) {
+        if (sensorLatestUs[id] != 0 && message.timestampUs - sensorLatestUs[id] < kSensorStaleUs) {
+            return false;
+        }
+    }
+
+    shown = message;
+    uint8_t contributors = 0;  // Bit per sensor that fed at least one channel
+    for (uint8_t channel = 0; channel < PARAMETER_CHANNEL_COUNT; channel++) {
+        const ParameterDescriptor& descriptor = parameter_descriptor(static_cast<ParameterChannel>(channel));
+        const uint16_t bit = 1u << channel;
+        int32_t sum = 0;
+        int32_t count = 0;
+        for (uint8_t id = 0; id < SENSOR_COUNT; id++) {
+            const SensorData& sample = sensorLatest[id];
+            bool fresh = sensorLatestUs[id] != 0 && message.timestampUs - sensorLatestUs[id] < kSensorStaleUs;
+            if (fresh && !(sample.unusableChannels & bit)) {
+                sum += sample.*descriptor.sensorField;
+                count++;
+                contributors |= 1u << id;
             }
-        buffers->mid_term_sum = 0.0f;
-        buffers->mid_term_count = 0;
+        }
+        if (count == 0) {
+            shown.data.unusableChannels |= bit;
+            continue;
+        }
+        // Average in the sensor's integer scaling, the float follows from it like in the I2C task
+        const int32_t mean = parameter_sensor_mean(sum, count);
+        shown.data.unusableChannels &= ~bit;
+        shown.data.*descriptor.sensorField = mean;
+        shown.data.*descriptor.field = mean / descriptor.sensorScale;
     }
-}
 
-void DisplayTask::cycleChartDisplayMode(bool up, bool reset) {
-    if (reset) {
-        currentDisplayMode = savedChartDisplayMode;
-        lv_obj_clear_state(ui_ChartTimeScreen_CheckboxShort, LV_STATE_CHECKED);
-        lv_obj_clear_state(ui_ChartTimeScreen_CheckboxMedium, LV_STATE_CHECKED);
-        lv_obj_clear_state(ui_ChartTimeScreen_CheckboxLong, LV_STATE_CHECKED);
-
-        // Restore saved checkbox states
-        if (savedChartDisplayMode == ChartDisplayMode::ShortTerm) {
-            lv_obj_add_state(ui_ChartTimeScreen_CheckboxShort, LV_STATE_CHECKED);
-        } else if (savedChartDisplayMode == ChartDisplayMode::MidTerm) {
-            lv_obj_add_state(ui_ChartTimeScreen_CheckboxMedium, LV_STATE_CHECKED);
-        } else if (savedChartDisplayMode == ChartDisplayMode::LongTerm) {
-            lv_obj_add_state(ui_ChartTimeScreen_CheckboxLong, LV_STATE_CHECKED);
+    // A restart or warm-up on any averaged sensor shows in the averaged series
+    for (uint8_t id = 0; id < SENSOR_COUNT; id++) {
+        if (contributors & (1u << id)) {
+            shown.data.quality |= sensorLatest[id].quality;
         }
+    }
+    return true;
+    #endif
+}
 
-    } else {
-        if (up) {
-            // Move checkbox selection up
-            if (currentDisplayMode == ChartDisplayMode::ShortTerm) {
-                lv_obj_clear_state(ui_ChartTimeScreen_CheckboxShort, LV_STATE_CHECKED);
-                lv_obj_add_state(ui_ChartTimeScreen_CheckboxLong, LV_STATE_CHECKED);
-                currentDisplayMode = ChartDisplayMode::LongTerm;
-            } else if (currentDisplayMode == ChartDisplayMode::MidTerm) {
-                lv_obj_clear_state(ui_ChartTimeScreen_CheckboxMedium, LV_STATE_CHECKED);
-                lv_obj_add_state(ui_ChartTimeScreen_CheckboxShort, LV_STATE_CHECKED);
-                currentDisplayMode = ChartDisplayMode::ShortTerm;
-            } else if (currentDisplayMode == ChartDisplayMode::LongTerm) {
-                lv_obj_clear_state(ui_ChartTimeScreen_CheckboxLong, LV_STATE_CHECKED);
-                lv_obj_add_state(ui_ChartTimeScreen_CheckboxMedium, LV_STATE_CHECKED);
-                currentDisplayMode = ChartDisplayMode::MidTerm;
+void DisplayTask::ingest_sample(const QueueMessage& message) {
+    #ifdef DEBUG_MODE
+    int64_t start = esp_timer_get_time();
+    #endif
+
+    const SensorData& data = message.data;
+    if (!historyClockStarted) {
+        historyEpochUs = message.timestampUs;
+        nextHistorySlot = 0;
+        historyClockStarted = true;
+    }
+
+    // Nearest slot, so the jitter of the I2C task's polling never moves a sample
+    const int64_t slot = (message.timestampUs - historyEpochUs + kHistorySlotUs / 2) / kHistorySlotUs;
+    if (slot < nextHistorySlot) {
+        // A second sample for a slot that is already written, e.g. after a late poll
+        if (slot + parameter_buffers[0].accumulators[0].inputs >= nextHistorySlot) {
+            for (uint8_t channel = 0; channel < HISTORY_CHANNELS; channel++) {
+                merge_late_sample(static_cast<ParameterChannel>(channel), data);
             }
         } else {
-            // Move checkbox selection down
-            if (currentDisplayMode == ChartDisplayMode::ShortTerm) {
-                lv_obj_clear_state(ui_ChartTimeScreen_CheckboxShort, LV_STATE_CHECKED);
-                lv_obj_add_state(ui_ChartTimeScreen_CheckboxMedium, LV_STATE_CHECKED);
-                currentDisplayMode = ChartDisplayMode::MidTerm;
-            } else if (currentDisplayMode == ChartDisplayMode::MidTerm) {
-                lv_obj_clear_state(ui_ChartTimeScreen_CheckboxMedium, LV_STATE_CHECKED);
-                lv_obj_add_state(ui_ChartTimeScreen_CheckboxLong, LV_STATE_CHECKED);
-                currentDisplayMode = ChartDisplayMode::LongTerm;
-            } else if (currentDisplayMode == ChartDisplayMode::LongTerm) {
-                lv_obj_clear_state(ui_ChartTimeScreen_CheckboxLong, LV_STATE_CHECKED);
-                lv_obj_add_state(ui_ChartTimeScreen_CheckboxShort, LV_STATE_CHECKED);
-                currentDisplayMode = ChartDisplayMode::ShortTerm;
+            lateSamples++;
+            #ifdef DEBUG_MODE
+            Serial.printf("DisplayTask: dropped sample %lld slots late (%u so far)\n",
+                          (long long)(nextHistorySlot - slot), lateSamples);
+            #endif
+        }
+        return;
+    }
+    const uint32_t missed = static_cast<uint32_t>(slot - nextHistorySlot);
+    nextHistorySlot = static_cast<uint32_t>(slot) + 1;
+
+    // All levels run on the shared clock, so every channel receives the same number of points.
+    // Channels the I2C task flagged as unusable (warm-up, out of range, sensor error) become gaps.
+    LevelPoints points;
+    for (uint8_t channel = 0; channel < HISTORY_CHANNELS; channel++) {
+        const ParameterChannel parameter = static_cast<ParameterChannel>(channel);
+        memset(points, 0, sizeof(points));
+        if (missed > 0) {
+            push_pyramid_gaps(channel_buffers(parameter), missed, points);
+        }
+        updateParameterBuffer(parameter, data, points);
+    }
+
+    // Log every point this sample added to a level to flash, in order. Gaps are folded into
+    // the gapsBefore of the next record, only a trailing gap is logged as a record of its own.
+    // The history store task batches the writes.
+    auto& history = HistoryStore::getInstance();
+    for (uint8_t level = 0; level < HISTORY_LEVELS && points[level] > 0; level++) {
+        // Points pushed out of the ring again by the same sample are gone from the chart too
+        const uint16_t stored = std::min<uint16_t>(points[level], kRingBufferSize);
+        uint16_t gaps = points[level] - stored;
+        for (uint16_t i = 0; i < stored; i++) {
+            int16_t values[HISTORY_CHANNELS];
+            bool usable = false;
+            for (uint8_t channel = 0; channel < HISTORY_CHANNELS; channel++) {
+                const HistoryTier& tier = parameter_buffers[channel].levels[level];
+                values[channel] = tier.points[(tier.head + kRingBufferSize - stored + i) % kRingBufferSize];
+                usable |= values[channel] != LV_CHART_POINT_NONE;
+            }
+            if (!usable && i + 1 < stored) {
+                gaps++;
+                continue;
+            }
+            history.append(level, (1u << HISTORY_CHANNELS) - 1, values, gaps);
+            gaps = 0;
+        }
+    }
+
+    #ifdef DEBUG_MODE
+    ingestCpuUs += esp_timer_get_time() - start;
+    if (++ingestSamples == kIngestReportSamples) {
+        Serial.printf("DisplayTask: %.1f us CPU/sample for %u levels, %u bytes of history buffers\n",
+                      (float)ingestCpuUs / ingestSamples, HISTORY_LEVELS,
+                      (unsigned)(PARAMETER_CHANNEL_COUNT * sizeof(ParameterBuffers)));
+        ingestSamples = 0;
+        ingestCpuUs = 0;
+    }
+    #endif
+}
+
+void DisplayTask::restore_history() {
+    for (uint8_t level = 0; level < HISTORY_LEVELS; level++) {
+        replay_history(level);
+    }
+
+    // Time spent powered off is unknown, separate the restored history from new samples
+    mark_history_gap();
+}
+
+void DisplayTask::replay_history(uint8_t level) {
+    // Only needed once at boot, so the 4.8KB buffer is borrowed from PSRAM instead of the task stack
+    HistoryRecord* records = static_cast<HistoryRecord*>(memory_alloc(MEMORY_REGION_HISTORY, kRingBufferSize * sizeof(HistoryRecord)));
+    if (records == nullptr) {
+        return;
+    }
+    size_t count = HistoryStore::getInstance().readLatest(level, records, kRingBufferSize, kRingBufferSize);
+
+    for (size_t i = 0; i < count; i++) {
+        const HistoryRecord& record = records[i];
+        bool rebooted = i > 0 && record.boot != records[i - 1].boot;
+
+        for (uint8_t channel = 0; channel < HISTORY_CHANNELS; channel++) {
+            HistoryTier* history = &parameter_buffers[channel].levels[level];
+            if (rebooted && history->last() != LV_CHART_POINT_NONE) {
+                history->push(LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE);
+            }
+            // Missed slots, one window of gaps clears the level
+            for (uint16_t gap = 0; gap < std::min<uint16_t>(record.gapsBefore, kRingBufferSize); gap++) {
+                history->push(LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE);
+            }
+            if (record.channelMask & (1u << channel)) {
+                lv_coord_t point = record.values[channel];
+                history->push(point, point, point);
             }
         }
     }
 
-    switch (currentDisplayMode) {
-        case ChartDisplayMode::ShortTerm:
-            // Update X-axis labels for all charts to show -2min30
-            lv_label_set_text(ui_PMScreen_XMinValue, "-2min30");
-            lv_label_set_text(ui_CO2Screen_XMinValue, "-2min30");
-            lv_label_set_text(ui_VOCScreen_XMinValue, "-2min30");
-            lv_label_set_text(ui_NOxScreen_XMinValue, "-2min30");
-            lv_label_set_text(ui_TempScreen_XMinValue, "-2min30");
-            lv_label_set_text(ui_RHScreen_XMinValue, "-2min30");
-            break;
-        case ChartDisplayMode::MidTerm:
-            // Update X-axis labels for all charts to show -60min
-            lv_label_set_text(ui_PMScreen_XMinValue, "-60min");
-            lv_label_set_text(ui_CO2Screen_XMinValue, "-60min");
-            lv_label_set_text(ui_VOCScreen_XMinValue, "-60min");
-            lv_label_set_text(ui_NOxScreen_XMinValue, "-60min");
-            lv_label_set_text(ui_TempScreen_XMinValue, "-60min");
-            lv_label_set_text(ui_RHScreen_XMinValue, "-60min");
-            break;
-        case ChartDisplayMode::LongTerm:
-            // Update X-axis labels for all charts to show -24h
-            lv_label_set_text(ui_PMScreen_XMinValue, "-24h");
-            lv_label_set_text(ui_CO2Screen_XMinValue, "-24h");
-            lv_label_set_text(ui_VOCScreen_XMinValue, "-24h");
-            lv_label_set_text(ui_NOxScreen_XMinValue, "-24h");
-            lv_label_set_text(ui_TempScreen_XMinValue, "-24h");
-            lv_label_set_text(ui_RHScreen_XMinValue, "-24h");
+    memory_free(MEMORY_REGION_HISTORY, records);
+
+    #ifdef DEBUG_MODE
+    Serial.printf("DisplayTask: restored %u history records of level %u\n", (unsigned)count, level);
+    #endif
+}
+
+void DisplayTask::mark_history_gap() {
+    for (uint8_t channel = 0; channel < HISTORY_CHANNELS; channel++) {
+        ParameterBuffers* buffers = &parameter_buffers[channel];
+        for (HistoryTier& tier : buffers->levels) {
+            if (tier.last() != LV_CHART_POINT_NONE) {
+                tier.push(LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE);
+            }
+        }
+
+        // Don't aggregate across the gap
+        for (LevelAccumulator& accumulator : buffers->accumulators) {
+            accumulator = LevelAccumulator();
+        }
+    }
+}
+
+void DisplayTask::updateParameterBuffer(ParameterChannel channel, const SensorData& data, LevelPoints& points) {
+    lv_coord_t point = chart_point(channel, data);
+    if (point == LV_CHART_POINT_NONE) {
+        push_pyramid_point(channel_buffers(channel), 0, 0, 0, point, point, points);
+    } else {
+        push_pyramid_point(channel_buffers(channel), 0, point, 1, point, point, points);
+    }
+}
+
+void DisplayTask::push_pyramid_point(ParameterBuffers* buffers, uint8_t level, int32_t sum, uint16_t samples,
+                                     lv_coord_t min_point, lv_coord_t max_point, LevelPoints& points) {
+    for (; level < HISTORY_LEVELS; level++) {
+        const lv_coord_t point = samples > 0 ? static_cast<lv_coord_t>(sum / samples) : LV_CHART_POINT_NONE;
+        buffers->levels[level].push(point, min_point, max_point);
+        if (points[level] < UINT16_MAX) {
+            points[level]++;
+        }
+        if (level + 1 == HISTORY_LEVELS) {
             break;
+        }
+
+        // Gaps count as inputs, so a point of level n always spans the same time. The sums
+        // carry the samples themselves: a point built from fewer usable samples weighs less.
+        LevelAccumulator& accumulator = buffers->accumulators[level];
+        if (samples > 0) {
+            accumulator.min = accumulator.samples == 0 ? min_point : std::min(accumulator.min, min_point);
+            accumulator.max = accumulator.samples == 0 ? max_point : std::max(accumulator.max, max_point);
+            accumulator.sum += sum;
+            accumulator.samples += samples;
+        }
+        accumulator.inputs++;
+        if (accumulator.inputs < kLevelRatios[level + 1]) {
+            break;
+        }
+
+        // The level above gets min/mean/max of the collected samples, or a gap if all were gaps
+        sum = accumulator.sum;
+        samples = accumulator.samples;
+        min_point = samples > 0 ? accumulator.min : LV_CHART_POINT_NONE;
+        max_point = samples > 0 ? accumulator.max : LV_CHART_POINT_NONE;
+        accumulator = LevelAccumulator();
+    }
+}
+
+void DisplayTask::push_pyramid_gaps(ParameterBuffers* buffers, uint32_t count, LevelPoints& points) {
+    for (uint8_t level = 0; level < HISTORY_LEVELS && count > 0; level++) {
+        // Beyond one window of gaps the ring holds nothing else
+        HistoryTier* tier = &buffers->levels[level];
+        for (uint32_t i = 0; i < std::min<uint32_t>(count, kRingBufferSize); i++) {
+            tier->push(LV_CHART_POINT_NONE, LV_CHART_POINT_NONE, LV_CHART_POINT_NONE);
+        }
+        points[level] = static_cast<uint16_t>(std::min<uint32_t>(points[level] + count, UINT16_MAX));
+        if (level + 1 == HISTORY_LEVELS) {
+            break;
+        }
+
+        // The gaps close the open bucket first, then fill whole buckets of the level above
+        LevelAccumulator& accumulator = buffers->accumulators[level];
+        const uint32_t inputs = accumulator.inputs + count;
+        const uint32_t completed = inputs / kLevelRatios[level + 1];
+        if (completed == 0) {
+            accumulator.inputs = static_cast<uint8_t>(inputs);
+            break;
+        }
+
+        LevelAccumulator closed = accumulator;
+        accumulator = LevelAccumulator();
+        accumulator.inputs = static_cast<uint8_t>(inputs % kLevelRatios[level + 1]);
+        if (closed.samples > 0) {
+            // The open bucket held samples, its point goes up like a regular aggregate
+            push_pyramid_point(buffers, level + 1, closed.sum, closed.samples, closed.min, closed.max, points);
+            count = completed - 1;
+        } else {
+            count = completed;
+        }
+    }
+}
+
+void DisplayTask::merge_late_sample(ParameterChannel channel, const SensorData& data) {
+    const lv_coord_t point = chart_point(channel, data);
+    if (point == LV_CHART_POINT_NONE) {
+        return;
+    }
+
+    // The slot's level 0 point is already written, but the level 1 bucket it belongs to
+    // is still open: count the sample there without adding an input
+    LevelAccumulator& accumulator = channel_buffers(channel)->accumulators[0];
+    accumulator.min = accumulator.samples == 0 ? point : std::min(accumulator.min, point);
+    accumulator.max = accumulator.samples == 0 ? point : std::max(accumulator.max, point);
+    accumulator.sum += point;
+    accumulator.samples++;
+}
+
+void DisplayTask::cycleChartDisplayMode(bool up, bool reset) {
+    if (reset) {
+        set_chart_level(savedChartLevel);
+    } else if (up) {
+        set_chart_level(currentChartLevel == 0 ? HISTORY_LEVELS - 1 : currentChartLevel - 1);
+    } else {
+        set_chart_level(currentChartLevel + 1 == HISTORY_LEVELS ? 0 : currentChartLevel + 1);
     }
     
-    // Update all chart series to reflect the new display mode
-    update_chart_series(ui_PMScreen_PMChart, pm1_series, &pm1_buffers,
-                       pm2p5_series, &pm2p5_buffers,
-                       pm4_series, &pm4_buffers,
-                       pm10_series, &pm10_buffers);
-    
-    update_chart_series(ui_CO2Screen_CO2Chart, co2_series, &co2_buffers);
-    update_chart_series(ui_VOCScreen_VOCChart, voc_series, &voc_buffers);
-    update_chart_series(ui_NOxScreen_NOxChart, nox_series, &nox_buffers);
-    update_chart_series(ui_TempScreen_TempChart, temp_series, &temp_buffers);
-    update_chart_series(ui_RHScreen_RHChart, rh_series, &rh_buffers);
+    // Update the visible chart to reflect the new window, the others follow when loaded
+    refresh_active_screen();
 }
 
 void DisplayTask::setDisplayBrightness(uint8_t brightness) {
@@ -0,0 +1,311 @@
+#include "tasks/history_store.h"
+#include "tasks/task_utils.h"
+#include "checksum.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+// Static member initialization
+TaskHandle_t HistoryStore::xHistoryStoreTaskHandle = nullptr;
+
+static constexpr uint32_t kRecordSize = sizeof(HistoryRecord);
+static constexpr uint32_t kErasedSequence = 0xFFFFFFFF;
+
+HistoryStore& HistoryStore::getInstance() {
+    static HistoryStore instance;
+    return instance;
+}
+
+bool HistoryStore::begin() {
+    _partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                          static_cast<esp_partition_subtype_t>(HISTORY_PARTITION_SUBTYPE),
+                                          HISTORY_PARTITION_LABEL);
+    if (_partition == nullptr) {
+        Serial.println("HistoryStore: history partition not found, history is not persisted");
+        return false;
+    }
+
+    // Samples arrive every second and keep half the partition for the dump command,
+    // the aggregate levels share the other half. Each level has its own ring, so the
+    // frequent low levels never push the rare high level records out of flash.
+    uint32_t sectors = _partition->size / HISTORY_SECTOR_SIZE;
+    uint32_t sampleSectors = sectors / 2;
+    uint32_t levelSectors = (sectors - sampleSectors) / (HISTORY_LEVELS - 1);
+    if (levelSectors < HISTORY_MIN_LEVEL_SECTORS) {
+        Serial.println("HistoryStore: history partition too small, history is not persisted");
+        _partition = nullptr;
+        return false;
+    }
+
+    uint32_t offset = 0;
+    for (uint8_t level = 0; level < HISTORY_LEVELS; level++) {
+        HistoryRegion& region = _regions[level];
+        region.offset = offset;
+        region.size = (level == 0 ? sampleSectors : levelSectors) * HISTORY_SECTOR_SIZE;
+        offset += region.size;
+    }
+
+    uint16_t lastBoot = 0;
+    for (HistoryRegion& region : _regions) {
+        scanRegion(region, lastBoot);
+    }
+    _boot = lastBoot + 1;
+
+    #ifdef DEBUG_MODE
+    Serial.printf("HistoryStore: boot %u, sample seq %u, %u sectors per aggregate level\n",
+                  _boot, _regions[0].nextSequence, levelSectors);
+    #endif
+    return true;
+}
+
+void HistoryStore::historyStoreTask(void* parameter) {
+    HistoryStore& store = getInstance();
+
+    #ifdef DEBUG_MODE
+    TaskWakeupCounter wakeupCounter = {"HistoryStore", 0, millis()};
+    #endif
+
+    while (true) {
+        // Sleep until append() reports a full batch or a record that must not be lost
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        #ifdef DEBUG_MODE
+        countTaskWakeup(wakeupCounter);
+        #endif
+
+        // Samples are written in full pages, the sparse aggregates whenever the task runs
+        for (uint8_t level = 0; level < HISTORY_LEVELS; level++) {
+            store.flushRegion(store._regions[level], level > 0);
+        }
+    }
+}
+
+bool HistoryStore::append(uint8_t level, uint16_t channelMask, const int16_t values[HISTORY_CHANNELS], uint16_t gapsBefore) {
+    if (_partition == nullptr || level >= HISTORY_LEVELS) {
+        return false;
+    }
+
+    HistoryRegion& region = _regions[level];
+    bool buffered = false;
+    bool wake = false;
+
+    portENTER_CRITICAL(&_pendingLock);
+    if (region.pendingCount < HISTORY_PENDING_RECORDS) {
+        HistoryRecord& record = region.pending[region.pendingCount++];
+        memset(&record, 0, sizeof(record));
+        record.sequence = region.nextSequence++;
+        record.level = level;
+        record.format = HISTORY_RECORD_FORMAT;
+        record.channelMask = channelMask;
+        memcpy(record.values, values, sizeof(record.values));
+        record.boot = _boot;
+        record.gapsBefore = gapsBefore;
+        buffered = true;
+        // Levels of HISTORY_IMMEDIATE_LEVEL and up cover minutes per record, write them out immediately
+        wake = region.pendingCount >= HISTORY_BATCH_RECORDS || level >= HISTORY_IMMEDIATE_LEVEL;
+    } else {
+        region.dropped++;
+    }
+    portEXIT_CRITICAL(&_pendingLock);
+
+    if (wake && xHistoryStoreTaskHandle != nullptr) {
+        xTaskNotifyGive(xHistoryStoreTaskHandle);
+    }
+    return buffered;
+}
+
+size_t HistoryStore::readLatest(uint8_t level, HistoryRecord* records, size_t maxRecords, size_t perChannel) {
+    if (maxRecords == 0) {
+        return 0;
+    }
+
+    HistoryCursor cursor;
+    openCursor(level, cursor);
+    uint16_t channelCounts[HISTORY_CHANNELS] = {};
+
+    // Walk backwards from the newest record, filling the buffer from its end
+    size_t count = 0;
+    HistoryRecord record;
+    while (count < maxRecords && readPrevious(cursor, record)) {
+        records[maxRecords - 1 - count++] = record;
+
+        if (perChannel > 0) {
+            bool complete = true;
+            for (size_t channel = 0; channel < HISTORY_CHANNELS; channel++) {
+                if (record.channelMask & (1u << channel)) {
+                    channelCounts[channel]++;
+                }
+                complete = complete && channelCounts[channel] >= perChannel;
+            }
+            if (complete) {
+                break;
+            }
+        }
+    }
+
+    // Move the records to the start of the buffer, oldest first
+    if (count < maxRecords) {
+        memmove(records, records + (maxRecords - count), count * sizeof(HistoryRecord));
+    }
+    return count;
+}
+
+void HistoryStore::openCursor(uint8_t level, HistoryCursor& cursor) {
+    cursor.level = level;
+    cursor.remaining = 0;
+    if (_partition == nullptr || level >= HISTORY_LEVELS) {
+        return;
+    }
+
+    HistoryRegion& region = _regions[level];
+    portENTER_CRITICAL(&_pendingLock);
+    cursor.position = region.readOffset / kRecordSize;
+    cursor.expected = region.lastSequence;
+    portEXIT_CRITICAL(&_pendingLock);
+    cursor.remaining = cursor.expected == 0 ? 0 : region.size / kRecordSize;
+}
+
+bool HistoryStore::readPrevious(HistoryCursor& cursor, HistoryRecord& record) {
+    if (cursor.remaining == 0) {
+        return false;
+    }
+    HistoryRegion& region = _regions[cursor.level];
+    uint32_t capacity = region.size / kRecordSize;
+
+    // Records of another level are left over from a different partition layout
+    while (cursor.remaining > 0) {
+        cursor.remaining--;
+        cursor.position = (cursor.position + capacity - 1) % capacity;
+        if (!readRecord(region, cursor.position, record) || record.sequence != cursor.expected) {
+            cursor.remaining = 0;
+            return false;
+        }
+        cursor.expected--;
+        if (record.level == cursor.level) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HistoryStore::readRecord(const HistoryRegion& region, uint32_t position, HistoryRecord& record) {
+    if (esp_partition_read(_partition, region.offset + position * kRecordSize, &record, kRecordSize) != ESP_OK) {
+        return false;
+    }
+    if (record.sequence == kErasedSequence || record.format != HISTORY_RECORD_FORMAT) {
+        return false;
+    }
+    return record.crc == crc16_ccitt(reinterpret_cast<const uint8_t*>(&record), offsetof(HistoryRecord, crc));
+}
+
+void HistoryStore::scanRegion(HistoryRegion& region, uint16_t& lastBoot) {
+    uint32_t sectors = region.size / HISTORY_SECTOR_SIZE;
+    uint32_t recordsPerSector = HISTORY_SECTOR_SIZE / kRecordSize;
+    HistoryRecord record;
+
+    // The newest sector is the one whose first record has the highest sequence
+    bool found = false;
+    uint32_t newestSector = 0;
+    uint32_t newestSequence = 0;
+    for (uint32_t sector = 0; sector < sectors; sector++) {
+        if (readRecord(region, sector * recordsPerSector, record) &&
+            (!found || record.sequence > newestSequence)) {
+            found = true;
+            newestSector = sector;
+            newestSequence = record.sequence;
+        }
+    }
+
+    region.pendingCount = 0;
+    region.dropped = 0;
+    if (!found) {
+        region.writeOffset = 0;
+        region.readOffset = 0;
+        region.lastSequence = 0;
+        region.nextSequence = 1;
+        return;
+    }
+
+    // Follow the contiguous sequence inside that sector to the newest record
+    uint32_t index = 0;
+    uint16_t newestBoot = 0;
+    for (uint32_t i = 0; i < recordsPerSector; i++) {
+        if (!readRecord(region, newestSector * recordsPerSector + i, record) ||
+            record.sequence != newestSequence + i) {
+            break;
+        }
+        index = i;
+        newestBoot = record.boot;
+    }
+
+    region.lastSequence = newestSequence + index;
+    region.nextSequence = region.lastSequence + 1;
+    region.writeOffset = (newestSector * HISTORY_SECTOR_SIZE + (index + 1) * kRecordSize) % region.size;
+    region.readOffset = region.writeOffset;
+    if (newestBoot > lastBoot) {
+        lastBoot = newestBoot;
+    }
+
+    // A record torn by a power loss can't be overwritten, continue in the next sector
+    if (region.writeOffset % HISTORY_SECTOR_SIZE != 0) {
+        uint8_t raw[kRecordSize];
+        esp_partition_read(_partition, region.offset + region.writeOffset, raw, kRecordSize);
+        for (uint8_t byte : raw) {
+            if (byte != 0xFF) {
+                region.writeOffset = ((region.writeOffset / HISTORY_SECTOR_SIZE + 1) * HISTORY_SECTOR_SIZE) % region.size;
+                break;
+            }
+        }
+    }
+}
+
+void HistoryStore::flushRegion(HistoryRegion& region, bool force) {
+    HistoryRecord batch[HISTORY_PENDING_RECORDS];
+    uint8_t count = 0;
+
+    portENTER_CRITICAL(&_pendingLock);
+    if (force || region.pendingCount >= HISTORY_BATCH_RECORDS) {
+        count = region.pendingCount;
+        memcpy(batch, region.pending, count * sizeof(HistoryRecord));
+        region.pendingCount = 0;
+    }
+    portEXIT_CRITICAL(&_pendingLock);
+
+    for (uint8_t i = 0; i < count; i++) {
+        batch[i].crc = crc16_ccitt(reinterpret_cast<const uint8_t*>(&batch[i]), offsetof(HistoryRecord, crc));
+    }
+
+    // Write in chunks that end at sector boundaries, erasing each sector before its first record
+    uint8_t written = 0;
+    while (written < count) {
+        if (region.writeOffset % HISTORY_SECTOR_SIZE == 0) {
+            esp_partition_erase_range(_partition, region.offset + region.writeOffset, HISTORY_SECTOR_SIZE);
+        }
+
+        uint32_t sectorRemaining = (HISTORY_SECTOR_SIZE - region.writeOffset % HISTORY_SECTOR_SIZE) / kRecordSize;
+        uint32_t chunk = std::min<uint32_t>(count - written, sectorRemaining);
+        if (esp_partition_write(_partition, region.offset + region.writeOffset, &batch[written], chunk * kRecordSize) != ESP_OK) {
+            #ifdef DEBUG_MODE
+            Serial.println("HistoryStore: flash write failed");
+            #endif
+        }
+
+        written += chunk;
+        region.writeOffset = (region.writeOffset + chunk * kRecordSize) % region.size;
+    }
+
+    // Make the new records visible to readers
+    if (count > 0) {
+        portENTER_CRITICAL(&_pendingLock);
+        region.readOffset = region.writeOffset;
+        region.lastSequence = batch[count - 1].sequence;
+        portEXIT_CRITICAL(&_pendingLock);
+    }
+
+    #ifdef DEBUG_MODE
+    if (region.dropped > 0) {
+        Serial.printf("HistoryStore: %u records dropped\n", region.dropped);
+        region.dropped = 0;
+    }
+    #endif
+}
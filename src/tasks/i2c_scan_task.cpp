@@ -1,74 +1,340 @@
 #include "tasks/i2c_scan_task.h"
 #include "tasks/live_data_manager.h"
+#include "tasks/task_utils.h"
+#include "parameter_descriptors.h"
+#include "i2c_profiler.h"
 #include <nvs_flash.h>
 #include <esp_partition.h>
 #include <esp_err.h>
+#include <esp_attr.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <time.h>
 
-// Initialize static member variables
-int32_t I2CScanTask::currentAltitude = 0;
-bool I2CScanTask::applyAltitude = false;
-int32_t I2CScanTask::currentFRCValue = 0;
-bool I2CScanTask::performFRC = false;
-uint16_t I2CScanTask::ucorrection = 0;
-int16_t I2CScanTask::correction = -32768;
+static_assert(SENSOR_COUNT >= 1 && SENSOR_COUNT <= 2, "One sensor per I2C controller, Wire and Wire1");
+
+// System time in seconds, keeps running across software resets but restarts at 0 after a power cycle
+static uint32_t system_seconds() {
+    return static_cast<uint32_t>(time(nullptr));
+}
+
+// Seconds since boot
+static uint32_t uptime_seconds() {
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000000);
+}
+
+// NVS key of a sensor's VOC checkpoint
+static void voc_state_key(uint8_t sensorId, char* key, size_t size) {
+    snprintf(key, size, "%s%u", PREF_VOC_STATE_KEY, (unsigned)sensorId);
+}
+
+static_assert(VOC_STATE_READ_INTERVAL <= VOC_STATE_SAVE_INTERVAL && VOC_STATE_SAVE_INTERVAL <= VOC_STATE_MAX_OFF_TIME,
+              "The checkpoint a power cycle restores must not trail the sensor by more than VOC_STATE_MAX_OFF_TIME");
+
+// RTC memory survives software, panic and watchdog resets but not a power cycle. The marker tells
+// the two apart, and with it whether the system time kept running since the checkpoint was taken.
+#define VOC_RESET_MARKER 0x564F4342u
+static RTC_NOINIT_ATTR uint32_t voc_reset_marker;
+static RTC_NOINIT_ATTR uint16_t voc_cold_boot;  // Boot counter at the last power-on
+
+struct VocBoot {
+    uint16_t boot;      // NVS boot counter, 0 if NVS could not be read
+    uint16_t coldBoot;  // Boot counter at the last power-on, the system time runs since then
+    bool cold;          // This boot started from power-on
+};
+
+// Boot counter and reset marker, evaluated once per boot and shared by all sensors
+static const VocBoot& voc_boot() {
+    static const VocBoot info = [] {
+        VocBoot result = {};
+        Preferences prefs;
+        if (prefs.begin(PREF_NAMESPACE, false)) {
+            result.boot = static_cast<uint16_t>(prefs.getUInt(PREF_VOC_BOOT_KEY, 0) + 1);
+            if (result.boot == 0) {
+                result.boot = 1;
+            }
+            prefs.putUInt(PREF_VOC_BOOT_KEY, result.boot);
+            prefs.end();
+        }
+        result.cold = voc_reset_marker != VOC_RESET_MARKER;
+        if (result.cold) {
+            voc_reset_marker = VOC_RESET_MARKER;
+            voc_cold_boot = result.boot;
+        }
+        result.coldBoot = voc_cold_boot;
+        return result;
+    }();
+    return info;
+}
 
 // I2CScanTask method implementations
-void I2CScanTask::setAltitude(int32_t altitude) {
-    currentAltitude = altitude;
-    applyAltitude = true;
-    
-    // Save altitude to preferences
-    Preferences prefs;
-    if (!prefs.begin(PREF_NAMESPACE, false)) {
-        #ifdef DEBUG_MODE
-        Serial.println("Failed to open preferences for writing");
+I2CScanTask::I2CScanTask(uint8_t sensorId, TwoWire& wire, int sda, int scl, uint8_t address)
+    : sensorId(sensorId), address(address), bus(wire, sda, scl) {}
+
+I2CScanTask& I2CScanTask::getInstance(uint8_t sensorId) {
+    static I2CScanTask instances[SENSOR_COUNT] = {
+        {0, Wire, PIN_IIC_SDA, PIN_IIC_SCL, SENSOR_I2C_ADDRESS},
+        #if SENSOR_COUNT > 1
+        {1, Wire1, PIN_IIC1_SDA, PIN_IIC1_SCL, SENSOR_I2C_ADDRESS},
         #endif
-        return;
+    };
+    return instances[sensorId < SENSOR_COUNT ? sensorId : 0];
+}
+
+uint8_t I2CScanTask::submitCommandToAll(const SensorCommand& command) {
+    uint8_t accepted = 0;
+    for (uint8_t id = 0; id < SENSOR_COUNT; id++) {
+        if (getInstance(id).submitCommand(command)) {
+            accepted++;
+        }
     }
-    prefs.putInt(PREF_ALTITUDE_KEY, altitude);
-    prefs.end();
-    
-    #ifdef DEBUG_MODE
-    Serial.printf("Altitude set to: %d meters\n", currentAltitude);
-    #endif
+    return accepted;
+}
+
+bool I2CScanTask::submitCommand(const SensorCommand& command) {
+    if (commandQueue == nullptr || xQueueSend(commandQueue, &command, 0) != pdTRUE) {
+        Serial.printf("Sensor %u rejected command %d\n", sensorId, static_cast<int>(command.type));
+        return false;
+    }
+    wakeTask();
+    return true;
+}
+
+void I2CScanTask::wakeTask() {
+    if (taskHandle != nullptr) {
+        xTaskNotifyGive(taskHandle);
+    }
+}
+
+void I2CScanTask::resetAcquisitionSchedule(uint32_t now) {
+    stats = {};
+    stats.periodMs = SENSOR_READY_CHECK_INTERVAL;
+    phaseLocked = false;
+    sampleLate = false;
+    lastReadyMs = now;
+    // The first sample after a start takes about one period
+    nextPollMs = now + SENSOR_READY_CHECK_INTERVAL - SENSOR_READY_LEAD_TIME;
 }
 
-int16_t I2CScanTask::setFRCValue(int32_t frcValue, uint32_t timeout) {
-    I2CScanTask::correction = -32768;
-    currentFRCValue = frcValue;
-    performFRC = true;
+void I2CScanTask::onSampleReady(uint32_t pollMs) {
+    // The edge lies between the last empty poll and this one. If the first poll already
+    // found data the edge is at or before the poll: anchor it at the poll, or at the
+    // prediction if the poll ran after it. Moving the edge a lead time earlier on every
+    // hit would walk the phase away until a miss pulled it back.
+    const uint32_t predictedMs = lastReadyMs + static_cast<uint32_t>(stats.periodMs);
+    uint32_t readyMs = pollMs;
+    if (sampleLate) {
+        readyMs = lastFailedPollMs + (pollMs - lastFailedPollMs) / 2;
+    } else if (phaseLocked && static_cast<int32_t>(predictedMs - pollMs) < 0) {
+        readyMs = predictedMs;
+    }
+
+    if (phaseLocked) {
+        uint32_t jitter = abs(static_cast<int32_t>(readyMs - predictedMs));
+        stats.jitterAvgMs += (jitter - stats.jitterAvgMs) / (stats.samples + 1);
+        if (jitter > stats.jitterMaxMs) {
+            stats.jitterMaxMs = jitter;
+        }
+
+        // Ignore intervals that include a missed sample
+        float interval = readyMs - lastReadyMs;
+        if (interval > stats.periodMs * 0.5f && interval < stats.periodMs * 1.5f) {
+            stats.periodMs += (interval - stats.periodMs) / SENSOR_PERIOD_SMOOTHING;
+        }
+    }
+
+    phaseLocked = true;
+    sampleLate = false;
+    lastReadyMs = readyMs;
+    nextPollMs = readyMs + static_cast<uint32_t>(stats.periodMs) - SENSOR_READY_LEAD_TIME;
+    stats.samples++;
+
     #ifdef DEBUG_MODE
-    Serial.printf("FRC value set to: %d ppm\n", currentFRCValue);
+    if (stats.samples % SENSOR_STATS_REPORT_SAMPLES == 0) {
+        Serial.printf("Sensor %u acquisition: period %.1f ms, jitter avg %.1f ms max %u ms, %.2f I2C transactions/sample, %u late polls\n",
+                      sensorId, stats.periodMs, stats.jitterAvgMs, stats.jitterMaxMs,
+                      (float)stats.bus.transactions / stats.samples, stats.latePolls);
+        Serial.printf("Sensor %u I2C bus: %u Hz, %u errors, %u clock step downs, %u recoveries\n",
+                      sensorId, (unsigned)bus.clock(), bus.stats().errors, bus.stats().stepDowns, bus.stats().recoveries);
+        Serial.printf("Sensor %u readout: %.1f bytes/sample, %.2f ms bus time/sample, %u number concentration reads, %u CRC errors\n",
+                      sensorId, (float)stats.bus.bytes / stats.samples, stats.bus.busUs / 1000.0f / stats.samples,
+                      stats.bus.groupReads[static_cast<uint8_t>(Sen66ReadGroup::NumberConcentrations)],
+                      stats.bus.crcErrors);
+    }
     #endif
-    // save current time and loop until timeout
-    uint32_t startTime = millis();
-    while (millis() - startTime < timeout) {
-        if (I2CScanTask::correction != -32768) {
+}
+
+void I2CScanTask::onSampleNotReady(uint32_t pollMs) {
+    // Polls run a lead time ahead of the predicted edge, an empty one is expected until
+    // the edge plus its usual jitter has passed
+    if (phaseLocked) {
+        const uint32_t predictedMs = lastReadyMs + static_cast<uint32_t>(stats.periodMs);
+        if (static_cast<int32_t>(pollMs - predictedMs) > static_cast<int32_t>(stats.jitterAvgMs) + SENSOR_LATE_TOLERANCE) {
+            stats.latePolls++;
+        }
+    }
+    sampleLate = true;
+    lastFailedPollMs = pollMs;
+    nextPollMs = pollMs + (phaseLocked ? SENSOR_LATE_RECHECK_TIME : SENSOR_READY_RECHECK_TIME);
+}
+
+void I2CScanTask::assessQuality(SensirionI2cSen66& sensor, SensorData& data) {
+    data.quality = 0;
+    data.unusableChannels = 0;
+
+    // The first sample of a run marks the restart in every channel
+    if (data.runtime_ticks == 1) {
+        data.quality |= SAMPLE_QUALITY_RESTART;
+        data.unusableChannels |= PARAMETER_ALL_CHANNELS;
+    }
+    if (data.runtime_ticks <= SENSOR_WARMUP_SAMPLES) {
+        data.quality |= SAMPLE_QUALITY_WARMING_UP;
+        data.unusableChannels |= PARAMETER_WARMUP_CHANNELS;
+    }
+
+    for (uint8_t channel = 0; channel < PARAMETER_CHANNEL_COUNT; channel++) {
+        const ParameterDescriptor& descriptor = parameter_descriptor(static_cast<ParameterChannel>(channel));
+        if (!parameter_sensor_is_valid(descriptor, data.*descriptor.sensorField)) {
+            data.quality |= SAMPLE_QUALITY_OUT_OF_RANGE;
+            data.unusableChannels |= 1u << channel;
+        }
+    }
+
+    // Errors are sticky in the sensor, one extra transaction per check interval is enough to catch them
+    if (data.runtime_ticks % SENSOR_STATUS_CHECK_SAMPLES == 1) {
+        SEN66DeviceStatus status;
+        if (i2c_profiled(sensorId, I2CCommand::ReadDeviceStatus, [&] { return sensor.readDeviceStatus(status); }) == 0) {
+            statusErrorChannels = 0;
+            if (status.value & (SEN66_STATUS_PM_ERROR | SEN66_STATUS_FAN_ERROR)) {
+                statusErrorChannels |= parameter_channel_bit(ParameterChannel::PM1p0) |
+                                       parameter_channel_bit(ParameterChannel::PM2p5) |
+                                       parameter_channel_bit(ParameterChannel::PM4p0) |
+                                       parameter_channel_bit(ParameterChannel::PM10p0);
+            }
+            if (status.value & SEN66_STATUS_CO2_ERROR) {
+                statusErrorChannels |= parameter_channel_bit(ParameterChannel::CO2);
+            }
+            if (status.value & SEN66_STATUS_GAS_ERROR) {
+                statusErrorChannels |= parameter_channel_bit(ParameterChannel::VOC) |
+                                       parameter_channel_bit(ParameterChannel::NOx);
+            }
+            if (status.value & SEN66_STATUS_RHT_ERROR) {
+                statusErrorChannels |= parameter_channel_bit(ParameterChannel::Temperature) |
+                                       parameter_channel_bit(ParameterChannel::Humidity);
+            }
             #ifdef DEBUG_MODE
-            Serial.printf("FRC calibration successful. Correction value: %d ppm\n", I2CScanTask::correction);
+            if (statusErrorChannels != 0) {
+                Serial.printf("Sensor %u reports device status 0x%08lx\n", sensorId, (unsigned long)status.value);
+            }
             #endif
-            return I2CScanTask::correction;
         }
-        vTaskDelay(pdMS_TO_TICKS(100));
+        // Command write and a two word response, read through the driver
+        stats.bus.transactions += 2;
+        stats.bus.bytes += 3 + 1 + 2 * 3;
+    }
+    if (statusErrorChannels != 0) {
+        data.quality |= SAMPLE_QUALITY_SENSOR_ERROR;
+        data.unusableChannels |= statusErrorChannels;
+    }
+}
+
+void I2CScanTask::executeCommand(SensirionI2cSen66& sensor, const SensorCommand& command) {
+    SensorCommandResult result = {command.type, false, command.value, sensorId};
+
+    // All commands require the sensor to be in idle mode
+    uint16_t error = i2c_profiled(sensorId, I2CCommand::StopMeasurement, [&] { return sensor.stopMeasurement(); });
+    if (error) {
+        #ifdef DEBUG_MODE
+        Serial.println("Error executing stopMeasurement");
+        #endif
+    }
+
+    switch (command.type) {
+        case SensorCommandType::SetAltitude: {
+            error = i2c_profiled(sensorId, I2CCommand::SetAltitude, [&] {
+                return sensor.setSensorAltitude(static_cast<uint16_t>(command.value));
+            });
+            if (!error) {
+                currentAltitude = command.value;
+
+                // Persist the altitude here so the caller never blocks on NVS. The setting is shared
+                // by all sensors, sensor 0 writes it once and the others only apply it.
+                if (sensorId == 0) {
+                    Preferences prefs;
+                    if (prefs.begin(PREF_NAMESPACE, false)) {
+                        prefs.putInt(PREF_ALTITUDE_KEY, currentAltitude);
+                        prefs.end();
+                    } else {
+                        #ifdef DEBUG_MODE
+                        Serial.println("Failed to open preferences for writing");
+                        #endif
+                    }
+                }
+
+                #ifdef DEBUG_MODE
+                Serial.printf("Altitude set to: %d meters\n", currentAltitude);
+                #endif
+            }
+            break;
+        }
+        case SensorCommandType::ForcedRecalibration: {
+            uint16_t ucorrection = 0;
+            error = i2c_profiled(sensorId, I2CCommand::ForcedRecalibration, [&] {
+                return sensor.performForcedCo2Recalibration(static_cast<uint16_t>(command.value), ucorrection);
+            });
+            // FRC correction [ppm CO2] = return value - 0x8000, 0xFFFF means the recalibration failed
+            if (!error && ucorrection != 0xFFFF) {
+                result.value = static_cast<int32_t>(ucorrection) - 0x8000;
+                #ifdef DEBUG_MODE
+                Serial.printf("FRC calibration successful. Correction value: %d ppm CO2\n", result.value);
+                #endif
+            } else if (!error) {
+                error = 1;
+            }
+            break;
+        }
+        case SensorCommandType::FanCleaning:
+            error = i2c_profiled(sensorId, I2CCommand::FanCleaning, [&] { return sensor.startFanCleaning(); });
+            if (!error) {
+                vTaskDelay(pdMS_TO_TICKS(SENSOR_FAN_CLEANING_TIME));
+            }
+            break;
+        case SensorCommandType::ShtHeater:
+            error = i2c_profiled(sensorId, I2CCommand::ShtHeater, [&] { return sensor.activateShtHeater(); });
+            if (!error) {
+                vTaskDelay(pdMS_TO_TICKS(SENSOR_SHT_HEATER_TIME));
+            }
+            break;
+    }
+
+    result.success = (error == 0);
+    if (!result.success) {
+        Serial.printf("Sensor %u command %d failed\n", sensorId, static_cast<int>(command.type));
+    }
+
+    // Restart the measurement
+    if (i2c_profiled(sensorId, I2CCommand::StartMeasurement, [&] { return sensor.startContinuousMeasurement(); })) {
+        #ifdef DEBUG_MODE
+        Serial.println("Error executing startContinuousMeasurement");
+        #endif
+    }
+
+    if (command.replyQueue != nullptr) {
+        xQueueSend(command.replyQueue, &result, 0);
+    }
+    if (command.replyTask != nullptr) {
+        xTaskNotify(command.replyTask, command.replyBits, eSetBits);
     }
-    #ifdef DEBUG_MODE
-    Serial.printf("FRC calibration timed out\n");
-    #endif
-    return I2CScanTask::correction;
 }
 
 // Initialize sensor
 bool I2CScanTask::initSensor(SensirionI2cSen66& sensor) {
-    // Initialize I2C
-    Wire.begin(PIN_IIC_SDA, PIN_IIC_SCL);
-    Wire.setClock(100000); // Set I2C clock to 100kHz
-    
     uint16_t error;
     char errorMessage[256];
     
-    sensor.begin(Wire, SENSOR_I2C_ADDRESS);
+    sensor.begin(bus.wire(), address);
     
-    error = sensor.deviceReset();
+    error = i2c_profiled(sensorId, I2CCommand::DeviceReset, [&] { return sensor.deviceReset(); });
     if (error) {
         #ifdef DEBUG_MODE
         Serial.print("Error trying to execute deviceReset(): ");
@@ -78,13 +344,29 @@ bool I2CScanTask::initSensor(SensirionI2cSen66& sensor) {
         return false;
     }
 
+    // The VOC checkpoint is only restored to the sensor it was taken from
+    int8_t serial[SEN66_SERIAL_NUMBER_SIZE] = {};
+    error = i2c_profiled(sensorId, I2CCommand::GetSerialNumber, [&] { return sensor.getSerialNumber(serial, SEN66_SERIAL_NUMBER_SIZE); });
+    if (error) {
+        #ifdef DEBUG_MODE
+        Serial.print("Error reading serial number: ");
+        errorToString(error, errorMessage, 256);
+        Serial.println(errorMessage);
+        #endif
+        return false;
+    }
+    memcpy(serialNumber, serial, SEN66_SERIAL_NUMBER_SIZE);
+    serialNumber[SEN66_SERIAL_NUMBER_SIZE - 1] = '\0';
+
     // Set temperature acceleration parameters
-    error = sensor.setTemperatureAccelerationParameters(
-        static_cast<uint16_t>(K),
-        static_cast<uint16_t>(P),
-        static_cast<uint16_t>(T1),
-        static_cast<uint16_t>(T2)
-    );
+    error = i2c_profiled(sensorId, I2CCommand::SetTemperatureAcceleration, [&] {
+        return sensor.setTemperatureAccelerationParameters(
+            static_cast<uint16_t>(K),
+            static_cast<uint16_t>(P),
+            static_cast<uint16_t>(T1),
+            static_cast<uint16_t>(T2)
+        );
+    });
     if (error) {
         #ifdef DEBUG_MODE
         Serial.print("Error setting temperature acceleration parameters: ");
@@ -95,12 +377,14 @@ bool I2CScanTask::initSensor(SensirionI2cSen66& sensor) {
     }
 
     // Set temperature offset parameters
-    error = sensor.setTemperatureOffsetParameters(
-        static_cast<int16_t>(SLOT_0_OFFSET),
-        static_cast<int16_t>(SLOT_0_SLOPE),
-        static_cast<uint16_t>(SLOT_0_TIME_CONSTANT),
-        static_cast<uint16_t>(SLOT_0_SLOT_TIME)
-    );
+    error = i2c_profiled(sensorId, I2CCommand::SetTemperatureOffset, [&] {
+        return sensor.setTemperatureOffsetParameters(
+            static_cast<int16_t>(SLOT_0_OFFSET),
+            static_cast<int16_t>(SLOT_0_SLOPE),
+            static_cast<uint16_t>(SLOT_0_TIME_CONSTANT),
+            static_cast<uint16_t>(SLOT_0_SLOT_TIME)
+        );
+    });
     if (error) {
         #ifdef DEBUG_MODE
         Serial.print("Error setting temperature offset parameters: ");
@@ -124,7 +408,7 @@ bool I2CScanTask::initSensor(SensirionI2cSen66& sensor) {
     
     // Apply altitude if it's not 0
     if (currentAltitude != 0) {
-        error = sensor.setSensorAltitude(static_cast<uint16_t>(currentAltitude));
+        error = i2c_profiled(sensorId, I2CCommand::SetAltitude, [&] { return sensor.setSensorAltitude(static_cast<uint16_t>(currentAltitude)); });
         if (error) {
             #ifdef DEBUG_MODE
             Serial.print("Error setting altitude: ");
@@ -138,25 +422,211 @@ bool I2CScanTask::initSensor(SensirionI2cSen66& sensor) {
         #endif
     }
     
+    // The state can only be written while the sensor is idle, the device reset above cleared it
+    restoreVocState(sensor);
+
     // Start measurement
-    error = sensor.startContinuousMeasurement();
+    error = i2c_profiled(sensorId, I2CCommand::StartMeasurement, [&] { return sensor.startContinuousMeasurement(); });
     if (error) {
         #ifdef DEBUG_MODE
         Serial.println("Error executing startContinuousMeasurement");
         #endif
         return false;
     }
+
+    vocLearningStartMs = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    vocReadMs = vocLearningStartMs;
     
     return true;
 }
 
+void I2CScanTask::loadVocCheckpoint() {
+    char key[16];
+    voc_state_key(sensorId, key, sizeof(key));
+
+    Preferences prefs;
+    if (!prefs.begin(PREF_NAMESPACE, true)) {
+        return;
+    }
+    vocCheckpointValid = prefs.getBytesLength(key) == sizeof(vocCheckpoint) &&
+                         prefs.getBytes(key, &vocCheckpoint, sizeof(vocCheckpoint)) == sizeof(vocCheckpoint) &&
+                         vocCheckpoint.version == VOC_STATE_FORMAT_VERSION;
+    prefs.end();
+}
+
+void I2CScanTask::restoreVocState(SensirionI2cSen66& sensor) {
+    vocLearningBase = 0;
+    if (!vocCheckpointValid) {
+        return;
+    }
+
+    const char* rejection = strncmp(vocCheckpoint.serialNumber, serialNumber, SEN66_SERIAL_NUMBER_SIZE) != 0
+                                ? "other sensor"
+                                : vocCheckpointRejection();
+    if (rejection != nullptr) {
+        #ifdef DEBUG_MODE
+        Serial.printf("Sensor %u discards its VOC checkpoint (%s)\n", sensorId, rejection);
+        #endif
+        vocCheckpointValid = false;
+        return;
+    }
+
+    uint16_t error = i2c_profiled(sensorId, I2CCommand::SetVocAlgorithmState, [&] {
+        return sensor.setVocAlgorithmState(vocCheckpoint.state, VOC_STATE_SIZE);
+    });
+    if (error) {
+        #ifdef DEBUG_MODE
+        Serial.println("Error restoring the VOC algorithm state");
+        #endif
+        return;
+    }
+    vocLearningBase = vocCheckpoint.learningSeconds;
+
+    #ifdef DEBUG_MODE
+    Serial.printf("Sensor %u restored its VOC algorithm state from %s, %u s learned\n", sensorId,
+                  vocCheckpointThisBoot ? "this boot" : voc_boot().cold ? "before the power cycle" : "before the reset",
+                  (unsigned)vocLearningBase);
+    #endif
+
+    // The restored state is the sensor's current one: a checkpoint from an earlier boot becomes
+    // this boot's, so a power cycle before the next regular save still finds it
+    if (!vocCheckpointThisBoot) {
+        stampVocCheckpoint();
+        saveVocCheckpoint(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    }
+}
+
+const char* I2CScanTask::vocCheckpointRejection() const {
+    const VocBoot& boot = voc_boot();
+    if (vocCheckpointThisBoot) {
+        return uptime_seconds() - vocCheckpoint.uptime > VOC_STATE_MAX_AGE ? "too old" : nullptr;
+    }
+    if (boot.boot == 0 || boot.coldBoot == 0 || vocCheckpoint.boot == 0) {
+        return "boot unknown";
+    }
+
+    // Cold boot: the time spent powered off is unknown, there is no battery backed clock. The boot
+    // that lost power rewrote the checkpoint every VOC_STATE_SAVE_INTERVAL, so one it wrote trails
+    // the sensor by at most VOC_STATE_MAX_OFF_TIME and is restored. Anything older is not.
+    if (boot.cold) {
+        return static_cast<uint16_t>(vocCheckpoint.boot + 1) != boot.boot ? "not from the previous boot" : nullptr;
+    }
+
+    // Reset: the system time ran on since the last power-on, so a checkpoint taken since then has a known age
+    const uint32_t now = system_seconds();
+    if (static_cast<uint16_t>(vocCheckpoint.boot - boot.coldBoot) > static_cast<uint16_t>(boot.boot - boot.coldBoot) ||
+        now < vocCheckpoint.savedAt) {
+        return "before the last power cycle";
+    }
+    return now - vocCheckpoint.savedAt > VOC_STATE_MAX_AGE ? "too old" : nullptr;
+}
+
+void I2CScanTask::stampVocCheckpoint() {
+    vocCheckpoint.savedAt = system_seconds();
+    vocCheckpoint.uptime = uptime_seconds();
+    vocCheckpoint.boot = voc_boot().boot;
+    vocCheckpointThisBoot = true;
+}
+
+bool I2CScanTask::saveVocCheckpoint(uint32_t now) {
+    char key[16];
+    voc_state_key(sensorId, key, sizeof(key));
+    Preferences prefs;
+    if (!prefs.begin(PREF_NAMESPACE, false)) {
+        #ifdef DEBUG_MODE
+        Serial.println("Failed to open preferences for writing");
+        #endif
+        return false;
+    }
+    bool written = prefs.putBytes(key, &vocCheckpoint, sizeof(vocCheckpoint)) == sizeof(vocCheckpoint);
+    prefs.end();
+    if (written) {
+        vocSaved = true;
+        vocSavedMs = now;
+    }
+    return written;
+}
+
+void I2CScanTask::checkpointVocState(SensirionI2cSen66& sensor, uint32_t now) {
+    if (now - vocReadMs < VOC_STATE_READ_INTERVAL * 1000UL) {
+        return;
+    }
+    vocReadMs = now;
+
+    // The state can be read while measuring, it is cheap enough to keep the RAM copy fresh
+    uint8_t state[VOC_STATE_SIZE];
+    uint16_t error = i2c_profiled(sensorId, I2CCommand::GetVocAlgorithmState, [&] {
+        return sensor.getVocAlgorithmState(state, VOC_STATE_SIZE);
+    });
+    // Command write and a four word response, read through the driver
+    stats.bus.transactions += 2;
+    stats.bus.bytes += 3 + 1 + 4 * 3;
+    if (error) {
+        #ifdef DEBUG_MODE
+        Serial.println("Error reading the VOC algorithm state");
+        #endif
+        return;
+    }
+
+    uint32_t learningSeconds = vocLearningBase + (now - vocLearningStartMs) / 1000;
+    vocCheckpoint.version = VOC_STATE_FORMAT_VERSION;
+    memcpy(vocCheckpoint.state, state, VOC_STATE_SIZE);
+    vocCheckpoint.learningSeconds = learningSeconds;
+    memcpy(vocCheckpoint.serialNumber, serialNumber, SEN66_SERIAL_NUMBER_SIZE);
+    stampVocCheckpoint();
+    vocCheckpointValid = true;
+
+    // Flash writes are rate limited, and a barely trained state never replaces a saved one
+    if (learningSeconds < VOC_STATE_MIN_LEARNING ||
+        (vocSaved && now - vocSavedMs < VOC_STATE_SAVE_INTERVAL * 1000UL)) {
+        return;
+    }
+
+    if (!saveVocCheckpoint(now)) {
+        return;
+    }
+
+    #ifdef DEBUG_MODE
+    Serial.printf("Sensor %u VOC checkpoint saved, %u s learned\n", sensorId, (unsigned)learningSeconds);
+    #endif
+}
+
+void I2CScanTask::startSensor(SensirionI2cSen66& sensor) {
+    uint32_t retryMs = SENSOR_RETRY_MIN_TIME;
+    while (!initSensor(sensor)) {
+        // Each failure is reported, a missing or unpowered sensor is retried at most once per SENSOR_RETRY_MAX_TIME
+        Serial.printf("Failed to initialize sensor %u, retrying in %u ms\n", sensorId, (unsigned)retryMs);
+        bus.reportError();
+        vTaskDelay(pdMS_TO_TICKS(retryMs));
+        bus.recover();
+        retryMs = std::min<uint32_t>(retryMs * 2, SENSOR_RETRY_MAX_TIME);
+    }
+}
+
 void I2CScanTask::i2cScanTask(void* parameter) {
-    // Initialize sensor
+    I2CScanTask& instance = parameter != nullptr ? *static_cast<I2CScanTask*>(parameter) : getInstance(0);
+    instance.run();
+}
+
+void I2CScanTask::run() {
+    taskHandle = xTaskGetCurrentTaskHandle();
+
+    // Initialize sensor, keeps retrying until it answers
+    if (!bus.begin()) {
+        Serial.println("Failed to start the I2C bus!");
+    }
     SensirionI2cSen66 sensor;
-    if (!initSensor(sensor)) {
-        Serial.println("Failed to initialize sensor!");
-        vTaskDelete(NULL);
-        return;
+    loadVocCheckpoint();
+    startSensor(sensor);
+
+    // Samples bypass the driver, see Sen66Readout
+    Sen66Readout readout;
+    readout.begin(bus.wire(), address, sensorId);
+
+    // Create command queue, submitCommand rejects commands until the sensor is running
+    commandQueue = xQueueCreate(kCommandQueueSize, sizeof(SensorCommand));
+    if (commandQueue == nullptr) {
+        Serial.println("Failed to create sensor command queue!");
     }
     
     // Initialize data structure
@@ -175,169 +645,100 @@ void I2CScanTask::i2cScanTask(void* parameter) {
         .rawVOC = 0,
         .rawNOx = 0,
         .rawCO2 = 0,
+        .numberConc0p5 = 0xFFFF,    // Unknown until the first number concentration read
+        .numberConc1p0 = 0xFFFF,
+        .numberConc2p5 = 0xFFFF,
+        .numberConc4p0 = 0xFFFF,
+        .numberConc10p0 = 0xFFFF,
+        .scaledPm1p0 = 0,
+        .scaledPm2p5 = 0,
+        .scaledPm4p0 = 0,
+        .scaledPm10p0 = 0,
+        .scaledHumidity = 0,
+        .scaledTemperature = 0,
+        .scaledVocIndex = 0,
+        .scaledNoxIndex = 0,
+        .scaledCo2 = 0,
+        .quality = 0,
+        .unusableChannels = 0,
+        .sensorId = sensorId,
         .runtime_ticks = 0
     };
     
-    uint32_t lastUpdate = 0;
+    resetAcquisitionSchedule(xTaskGetTickCount() * portTICK_PERIOD_MS);
+
+    #ifdef DEBUG_MODE
+    TaskWakeupCounter wakeupCounter = {pcTaskGetName(nullptr), 0, millis()};
+    #endif
     
     while (true) {
         uint32_t currentTime = xTaskGetTickCount() * portTICK_PERIOD_MS;
 
-        // if a new altitude is set, stop the measurement, set the altitude, and start the measurement again
-        if (applyAltitude) {
-            // Stop continuous measurement
-            uint16_t error = sensor.stopMeasurement();
-            if (error) {
-                #ifdef DEBUG_MODE
-                char errorMessage[256];
-                errorToString(error, errorMessage, 256);
-                Serial.print("Error stopping measurement: ");
-                Serial.println(errorMessage);
-                #endif
+        #ifdef DEBUG_MODE
+        countTaskWakeup(wakeupCounter);
+        #endif
+
+        // Run queued commands between measurements
+        SensorCommand command;
+        if (commandQueue != nullptr && xQueueReceive(commandQueue, &command, 0) == pdTRUE) {
+            executeCommand(sensor, command);
+            data.runtime_ticks = 0;
+            resetAcquisitionSchedule(xTaskGetTickCount() * portTICK_PERIOD_MS);
+            continue;
+        }
+        
+        // Poll only once the scheduler expects the next sample to be ready
+        if (static_cast<int32_t>(currentTime - nextPollMs) >= 0) {
+            bool dataReady;
+            uint16_t error = readout.readDataReady(dataReady, stats.bus);
+            if (!error && dataReady) {
+                // One bus session for every response group due for this sample
+                error = readout.readSample(data.runtime_ticks + 1, data, stats.bus);
             }
             
-            // Set the altitude using the correct method
-            error = sensor.setSensorAltitude(static_cast<uint16_t>(currentAltitude));
             if (error) {
                 #ifdef DEBUG_MODE
                 char errorMessage[256];
                 errorToString(error, errorMessage, 256);
-                Serial.print("Error setting altitude: ");
+                Serial.print("Error reading values: ");
                 Serial.println(errorMessage);
                 #endif
-            }
-
-            // Start measurement
-            error = sensor.startContinuousMeasurement();
-            if (error) {
-                #ifdef DEBUG_MODE
-                Serial.println("Error executing startContinuousMeasurement");
-                #endif
-            }
-            
-            data.runtime_ticks = 0;
-            applyAltitude = false;
-        }
+                bus.reportError();
+                if (bus.consecutiveErrors() >= SENSOR_REINIT_ERRORS) {
+                    // The sensor stopped answering: free the bus and start over
+                    bus.recover();
+                    startSensor(sensor);
+                    data.runtime_ticks = 0;
+                    resetAcquisitionSchedule(xTaskGetTickCount() * portTICK_PERIOD_MS);
+                    continue;
+                }
+                // Back off instead of re-polling immediately
+                nextPollMs = currentTime + SENSOR_READY_RECHECK_TIME;
+            } else if (dataReady) {
+                bus.reportSuccess();
 
-        // if a new FRC value is set, stop the measurement, set the FRC value, and start the measurement again
-        if (performFRC) {
-            // Stop continuous measurement
-            uint16_t error = sensor.stopMeasurement();
-            if (error) {
-                #ifdef DEBUG_MODE
-                Serial.println("Error executing stopMeasurement");
-                #endif
-            }
-            
-            // Set the FRC value
-            error = sensor.performForcedCo2Recalibration(static_cast<uint16_t>(currentFRCValue), I2CScanTask::ucorrection);
-            // Adjust correction value: FRC correction [ppm CO2] = return value - 0x8000
-            I2CScanTask::correction = I2CScanTask::ucorrection - 0x8000;
-            if (error) {
-                #ifdef DEBUG_MODE
-                Serial.println("Error setting FRC value");
-                #endif
-            } else {
-                #ifdef DEBUG_MODE
-                Serial.printf("FRC calibration successful. Correction value: %d ppm CO2\n", I2CScanTask::correction);
-                #endif
-            }   
-            
-            // Start measurement
-            error = sensor.startContinuousMeasurement();
-            if (error) {
-                #ifdef DEBUG_MODE
-                Serial.println("Error executing startContinuousMeasurement");
-                #endif
-            }
-            
-            data.runtime_ticks = 0;
-            performFRC = false;
-        }
-        
-        // Wait 1000ms before checking if data is ready
-        if (currentTime - lastUpdate >= SENSOR_READY_CHECK_INTERVAL) {
-            uint8_t padding;
-            bool dataReady;
-            uint16_t error = sensor.getDataReady(padding, dataReady);
-            
-            if (!error && dataReady) {
-                float tempPm1p0, tempPm2p5, tempPm4p0, tempPm10p0;
-                float tempHumidity, tempTemperature;
-                float tempVocIndex, tempNoxIndex;
-                uint16_t tempCo2;
-                int16_t tempRawHumidity, tempRawTemperature;
-                uint16_t tempRawVOC, tempRawNOx, tempRawCO2;
+                // Increment runtime counter
+                data.runtime_ticks++;
                 
-                error = sensor.readMeasuredValues(
-                    tempPm1p0, tempPm2p5, tempPm4p0, tempPm10p0,
-                    tempHumidity, tempTemperature,
-                    tempVocIndex, tempNoxIndex,
-                    tempCo2
-                );
+                onSampleReady(currentTime);
                 
-                if (error) {
-                    #ifdef DEBUG_MODE
-                    char errorMessage[256];
-                    errorToString(error, errorMessage, 256);
-                    Serial.print("Error reading values: ");
-                    Serial.println(errorMessage);
-                    #endif
-                } else {
-                    // Read raw values
-                    error = sensor.readMeasuredRawValues(
-                        tempRawHumidity, tempRawTemperature,
-                        tempRawVOC, tempRawNOx, tempRawCO2
-                    );
-                    
-                    if (error) {
-                        #ifdef DEBUG_MODE
-                        char errorMessage[256];
-                        errorToString(error, errorMessage, 256);
-                        Serial.print("Error reading raw values: ");
-                        Serial.println(errorMessage);
-                        #endif
-                    } else {
-                        // Update particle mass concentrations
-                        data.pm1p0 = tempPm1p0;
-                        data.pm2p5 = tempPm2p5;
-                        data.pm4p0 = tempPm4p0;
-                        data.pm10p0 = tempPm10p0;
-                        
-                        // Update environmental parameters
-                        data.humidity = tempHumidity;
-                        data.temperature = tempTemperature;
-                        
-                        // Update air quality indices
-                        data.vocIndex = tempVocIndex;
-                        data.noxIndex = tempNoxIndex;
-                        
-                        // Update raw values
-                        data.rawHumidity = tempRawHumidity;
-                        data.rawTemperature = tempRawTemperature;
-                        data.rawVOC = tempRawVOC;
-                        data.rawNOx = tempRawNOx;
-                        data.rawCO2 = tempRawCO2;
-                        
-                        // Update gas concentration
-                        data.co2 = tempCo2;
-                        
-                        // Increment runtime counter
-                        data.runtime_ticks++;
-                        
-                        lastUpdate = currentTime;
-                        
-                        // Publish data through LiveDataManager
-                        LiveDataManager::getInstance().publish(data);
-                    }
-                }
+                // Commands restart the measurement, the quality bits tell subscribers
+                // so they can keep their history across it
+                assessQuality(sensor, data);
+
+                // Publish data through LiveDataManager
+                LiveDataManager::getInstance().publish(data);
+
+                checkpointVocState(sensor, currentTime);
             } else {
-                // Data not ready, wait another 100ms
-                vTaskDelay(pdMS_TO_TICKS(SENSOR_READY_RECHECK_TIME));
+                bus.reportSuccess();
+
+                // Sample is late, re-poll shortly
+                onSampleNotReady(currentTime);
             }
         } else {
-            // Wait until we're close to the next reading time
-            vTaskDelay(pdMS_TO_TICKS(SENSOR_READY_RECHECK_TIME));
+            // Sleep until the next poll is due, a queued SensorCommand wakes us early through wakeTask
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(nextPollMs - currentTime));
         }
     }
 } 
\ No newline at end of file
@@ -1,111 +1,140 @@
 #include "tasks/live_data_manager.h"
-
-// Static member initialization
-TaskHandle_t LiveDataManager::xLiveDataManagerTaskHandle = nullptr;
+#include <esp_timer.h>
 
 LiveDataManager& LiveDataManager::getInstance() {
     static LiveDataManager instance;
     return instance;
 }
 
-void LiveDataManager::liveDataManagerTask(void* parameter) {
-    LiveDataManager& manager = getInstance();
-    
-    // Create ingress queue
-    manager._ingressQueue = xQueueCreate(QUEUE_SIZE, sizeof(QueueMessage));
-    if (manager._ingressQueue == nullptr) {
-        Serial.println("Failed to create ingress queue!");
-        vTaskDelete(NULL);
-        return;
-    }
-    
-    // Initialize subscriptions
-    for (auto& sub : manager._subscriptions) {
-        sub.active = false;
-    }
-    
-    QueueMessage message;
+bool LiveDataManager::subscribe(TaskHandle_t subscriber) {
+    return addSubscription(subscriber);
+}
+
+void LiveDataManager::unsubscribe(TaskHandle_t subscriber) {
+    removeSubscription(subscriber);
+}
+
+bool LiveDataManager::publish(const SensorData& data) {
+    // The critical section keeps the writer from being preempted while the lock is odd,
+    // so readers on the other core only ever spin for the duration of one struct copy.
+    // It also orders the sensor tasks: samples get their sequence in arrival order.
+    portENTER_CRITICAL(&_publishLock);
+
+    uint32_t sequence = _publishedSequence.load(std::memory_order_relaxed) + 1;
+    SampleSlot& slot = _slots[sequence % SAMPLE_SLOTS];
+
+    // Mark the slot as being written, readers retry until the lock is even again
+    uint32_t lock = slot.lock.load(std::memory_order_relaxed);
+    slot.lock.store(lock + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.message.data = data;
+    slot.message.timestamp = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    slot.message.timestampUs = esp_timer_get_time();
+    slot.sequence.store(sequence, std::memory_order_relaxed);
+
+    slot.lock.store(lock + 2, std::memory_order_release);
+    _publishedSequence.store(sequence, std::memory_order_release);
+
+    portEXIT_CRITICAL(&_publishLock);
+
+    notifySubscribers();
+    return true;
+}
+
+bool LiveDataManager::readNext(uint32_t& lastSequence, QueueMessage& message) const {
     while (true) {
-        // Wait for new data
-        if (xQueueReceive(manager._ingressQueue, &message, pdMS_TO_TICKS(QUEUE_TIMEOUT_MS)) == pdTRUE) {
-            // Forward data to all active subscribers
-            manager.forwardData(message);
+        uint32_t latest = latestSequence();
+        if (latest == lastSequence) {
+            return false;
         }
-        
-        // Small delay to prevent task starvation
-        vTaskDelay(pdMS_TO_TICKS(10));
+
+        uint32_t next = lastSequence + 1;
+        if (latest - next >= SAMPLE_SLOTS) {
+            // Too far behind, the older slots have been overwritten already
+            #ifdef DEBUG_MODE
+            Serial.printf("LiveDataManager: subscriber skipped %u samples\n", (unsigned)(latest - SAMPLE_SLOTS + 1 - next));
+            #endif
+            next = latest - SAMPLE_SLOTS + 1;
+        }
+
+        if (readSlot(next, message)) {
+            lastSequence = next;
+            return true;
+        }
+        // The slot was reused while reading, start over from the new latest sequence
     }
 }
 
-bool LiveDataManager::subscribe(TaskHandle_t subscriber, QueueHandle_t* queue) {
-    // Create queue for subscriber
-    *queue = xQueueCreate(QUEUE_SIZE, sizeof(QueueMessage));
-    if (*queue == nullptr) {
-        Serial.println("Failed to create subscriber queue!");
-        return false;
+bool LiveDataManager::readSlot(uint32_t sequence, QueueMessage& message) const {
+    const SampleSlot& slot = _slots[sequence % SAMPLE_SLOTS];
+
+    while (true) {
+        uint32_t lockBefore = slot.lock.load(std::memory_order_acquire);
+        if (lockBefore & 1) {
+            continue;  // Write in progress, it only takes a struct copy
+        }
+
+        message = slot.message;
+        uint32_t slotSequence = slot.sequence.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (slot.lock.load(std::memory_order_relaxed) == lockBefore) {
+            return slotSequence == sequence;
+        }
     }
-    
-    // Add subscription
-    return addSubscription(subscriber, *queue);
 }
 
-void LiveDataManager::unsubscribe(TaskHandle_t subscriber) {
-    removeSubscription(subscriber);
-}
+void LiveDataManager::notifySubscribers() {
+    TaskHandle_t subscribers[MAX_SUBSCRIBERS];
+    size_t count = 0;
 
-bool LiveDataManager::publish(const SensorData& data) {
-    QueueMessage message;
-    message.data = data;
-    message.timestamp = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    
-    if (xQueueSend(_ingressQueue, &message, pdMS_TO_TICKS(QUEUE_TIMEOUT_MS)) != pdTRUE) {
-        handleQueueError("publish");
-        return false;
+    portENTER_CRITICAL(&_subscriptionLock);
+    for (const auto& sub : _subscriptions) {
+        if (sub.active) {
+            subscribers[count++] = sub.subscriber;
+        }
+    }
+    portEXIT_CRITICAL(&_subscriptionLock);
+
+    // Setting a notification bit never blocks, a busy subscriber reads the store later
+    for (size_t i = 0; i < count; i++) {
+        xTaskNotify(subscribers[i], LIVE_DATA_NOTIFY_BIT, eSetBits);
     }
-    
-    return true;
 }
 
-bool LiveDataManager::addSubscription(TaskHandle_t subscriber, QueueHandle_t queue) {
+bool LiveDataManager::addSubscription(TaskHandle_t subscriber) {
+    bool added = false;
+
+    portENTER_CRITICAL(&_subscriptionLock);
     for (auto& sub : _subscriptions) {
         if (!sub.active) {
             sub.subscriber = subscriber;
-            sub.queue = queue;
             sub.active = true;
-            return true;
+            added = true;
+            break;
         }
     }
-    
-    Serial.println("No free subscription slots available!");
-    return false;
+    portEXIT_CRITICAL(&_subscriptionLock);
+
+    if (!added) {
+        Serial.println("No free subscription slots available!");
+    }
+    return added;
 }
 
 bool LiveDataManager::removeSubscription(TaskHandle_t subscriber) {
+    bool removed = false;
+
+    portENTER_CRITICAL(&_subscriptionLock);
     for (auto& sub : _subscriptions) {
         if (sub.active && sub.subscriber == subscriber) {
-            if (sub.queue != nullptr) {
-                vQueueDelete(sub.queue);
-            }
             sub.active = false;
-            return true;
+            removed = true;
+            break;
         }
     }
-    return false;
-}
+    portEXIT_CRITICAL(&_subscriptionLock);
 
-void LiveDataManager::forwardData(const QueueMessage& message) {
-    for (const auto& sub : _subscriptions) {
-        if (sub.active && sub.queue != nullptr) {
-            if (xQueueSend(sub.queue, &message, pdMS_TO_TICKS(QUEUE_TIMEOUT_MS)) != pdTRUE) {
-                handleQueueError("forward");
-            }
-        }
-    }
+    return removed;
 }
-
-void LiveDataManager::handleQueueError(const char* operation) {
-    #ifdef DEBUG_MODE
-    Serial.print("Queue error during ");
-    Serial.println(operation);
-    #endif
-} 
\ No newline at end of file
@@ -1,45 +1,328 @@
 #include <Arduino.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include "tasks/serial_logging_task.h"
 #include "tasks/live_data_manager.h"
+#include "tasks/history_store.h"
+#include "tasks/i2c_scan_task.h"
+#include "tasks/task_utils.h"
+#include "telemetry_protocol.h"
+#include "parameter_descriptors.h"
+#include "memory_placement.h"
+#include "i2c_profiler.h"
 
-// Queue handle for receiving data
-static QueueHandle_t xDataQueue = nullptr;
+// Notification bit set when serial input arrives (bit 0 is LIVE_DATA_NOTIFY_BIT)
+#define SERIAL_COMMAND_NOTIFY_BIT (1UL << 1)
+#define SERIAL_COMMAND_MAX_LENGTH 32
+
+static const char* kTextHeader =
+    "PM1.0\tPM2.5\tPM4.0\tPM10.0\tRH\tT\tVOC\tNOx\tCO2\tRaw RH\tRaw T\tRaw VOC\tRaw NOx\tRaw CO2"
+    "\tNC0.5\tNC1.0\tNC2.5\tNC4.0\tNC10";
+
+// Output format, switched at runtime with "mode text" / "mode bin"
+enum class LogMode {
+    Text,
+    Binary
+};
+
+// Cost of the current output mode
+struct LogStats {
+    uint32_t samples;
+    uint32_t bytes;
+    uint64_t cpuUs;
+};
+
+static LogMode logMode = LogMode::Text;
+static LogStats logStats = {};
+static char commandLine[SERIAL_COMMAND_MAX_LENGTH];
+static size_t commandLength = 0;
+
+#if ARDUINO_USB_MODE && ARDUINO_USB_CDC_ON_BOOT
+static void onSerialReceive(void* arg, esp_event_base_t base, int32_t id, void* data) {
+    if (xSerialLogTaskHandle != nullptr) {
+        xTaskNotify(xSerialLogTaskHandle, SERIAL_COMMAND_NOTIFY_BIT, eSetBits);
+    }
+}
+#endif
+
+static void setLogMode(LogMode mode) {
+    logMode = mode;
+    logStats = {};
+    if (mode == LogMode::Text) {
+        // The column header is printed once per text session instead of once per line
+        Serial.println(kTextHeader);
+    }
+}
+
+static void logText(const SensorData& data) {
+    char line[200];
+    int length = snprintf(line, sizeof(line),
+        "%.2f\t%.2f\t%.2f\t%.2f\t%.2f\t%.2f\t%d\t%d\t%d\t%.2f\t%.2f\t%u\t%u\t%u\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\r\n",
+        data.pm1p0, data.pm2p5, data.pm4p0, data.pm10p0,
+        data.humidity, data.temperature,
+        (int)data.vocIndex, (int)data.noxIndex, (int)data.co2,
+        data.rawHumidity / 100.0f, data.rawTemperature / 200.0f,
+        (unsigned)data.rawVOC, (unsigned)data.rawNOx, (unsigned)data.rawCO2,
+        data.numberConc0p5 / 10.0f, data.numberConc1p0 / 10.0f, data.numberConc2p5 / 10.0f,
+        data.numberConc4p0 / 10.0f, data.numberConc10p0 / 10.0f);
+    if (length > 0) {
+        size_t bytes = std::min<size_t>(length, sizeof(line) - 1);
+        Serial.write(reinterpret_cast<const uint8_t*>(line), bytes);
+        logStats.bytes += bytes;
+    }
+}
+
+static void writeFrame(const void* payload, size_t length) {
+    uint8_t frame[TELEMETRY_MAX_FRAME];
+    size_t frameLength = telemetry_encode_frame(static_cast<const uint8_t*>(payload), length, frame);
+    Serial.write(frame, frameLength);
+    logStats.bytes += frameLength;
+}
+
+// Value of a channel in the sensor's integer scaling
+static int32_t sensor_scaled(const SensorData& data, ParameterChannel channel) {
+    return data.*parameter_descriptor(channel).sensorField;
+}
+
+static void logBinary(const QueueMessage& message) {
+    const SensorData& data = message.data;
+
+    // The sensor's own integers, the floats were derived from these values
+    TelemetrySample sample;
+    sample.header = {TELEMETRY_PROTOCOL_VERSION, static_cast<uint8_t>(TelemetryRecordType::Sample)};
+    sample.timestamp = message.timestamp;
+    sample.runtimeTicks = data.runtime_ticks;
+    sample.pm1p0 = static_cast<uint16_t>(sensor_scaled(data, ParameterChannel::PM1p0));
+    sample.pm2p5 = static_cast<uint16_t>(sensor_scaled(data, ParameterChannel::PM2p5));
+    sample.pm4p0 = static_cast<uint16_t>(sensor_scaled(data, ParameterChannel::PM4p0));
+    sample.pm10p0 = static_cast<uint16_t>(sensor_scaled(data, ParameterChannel::PM10p0));
+    sample.humidity = static_cast<int16_t>(sensor_scaled(data, ParameterChannel::Humidity));
+    sample.temperature = static_cast<int16_t>(sensor_scaled(data, ParameterChannel::Temperature));
+    sample.vocIndex = static_cast<int16_t>(sensor_scaled(data, ParameterChannel::VOC));
+    sample.noxIndex = static_cast<int16_t>(sensor_scaled(data, ParameterChannel::NOx));
+    sample.co2 = static_cast<uint16_t>(sensor_scaled(data, ParameterChannel::CO2));
+    sample.rawHumidity = data.rawHumidity;
+    sample.rawTemperature = data.rawTemperature;
+    sample.rawVOC = data.rawVOC;
+    sample.rawNOx = data.rawNOx;
+    sample.rawCO2 = data.rawCO2;
+    sample.numberConc0p5 = data.numberConc0p5;
+    sample.numberConc1p0 = data.numberConc1p0;
+    sample.numberConc2p5 = data.numberConc2p5;
+    sample.numberConc4p0 = data.numberConc4p0;
+    sample.numberConc10p0 = data.numberConc10p0;
+    sample.sensorId = data.sensorId;
+
+    writeFrame(&sample, sizeof(sample));
+}
+
+static void dumpHistory() {
+    // Always binary: a full dump is several hundred kilobytes
+    struct __attribute__((packed)) {
+        TelemetryHeader header;
+        HistoryRecord record;
+    } payload;
+    payload.header = {TELEMETRY_PROTOCOL_VERSION, static_cast<uint8_t>(TelemetryRecordType::History)};
+
+    auto& history = HistoryStore::getInstance();
+    uint32_t count = 0;
+    // Coarsest level first, so an interrupted dump still holds the longest view
+    for (int level = HISTORY_LEVELS - 1; level >= 0; level--) {
+        HistoryCursor cursor;
+        HistoryRecord record;
+        history.openCursor(static_cast<uint8_t>(level), cursor);
+        while (history.readPrevious(cursor, record)) {
+            memcpy(&payload.record, &record, sizeof(record));
+            writeFrame(&payload, sizeof(payload));
+            count++;
+        }
+    }
+
+    struct __attribute__((packed)) {
+        TelemetryHeader header;
+        uint32_t count;
+    } end = {{TELEMETRY_PROTOCOL_VERSION, static_cast<uint8_t>(TelemetryRecordType::DumpEnd)}, count};
+    writeFrame(&end, sizeof(end));
+}
+
+static void printStats() {
+    if (logStats.samples == 0) {
+        Serial.println("No samples logged in this mode yet");
+        return;
+    }
+    Serial.printf("%s mode: %.1f bytes/sample, %.1f us CPU/sample over %u samples\n",
+                  logMode == LogMode::Text ? "text" : "binary",
+                  (float)logStats.bytes / logStats.samples,
+                  (float)logStats.cpuUs / logStats.samples,
+                  logStats.samples);
+}
+
+static void printHeap(const char* name, uint32_t caps) {
+    size_t total = heap_caps_get_total_size(caps);
+    if (total == 0) {
+        Serial.printf("%-9s not available\n", name);
+        return;
+    }
+    Serial.printf("%-9s %7u of %7u bytes free, min %7u, largest block %7u\n", name,
+                  (unsigned)heap_caps_get_free_size(caps), (unsigned)total,
+                  (unsigned)heap_caps_get_minimum_free_size(caps),
+                  (unsigned)heap_caps_get_largest_free_block(caps));
+}
+
+static void printMemory() {
+    printHeap("Internal", MALLOC_CAP_INTERNAL);
+    printHeap("PSRAM", MALLOC_CAP_SPIRAM);
+    for (int region = 0; region < MEMORY_REGION_COUNT; region++) {
+        memory_region_stats_t stats;
+        memory_region_get_stats(static_cast<memory_region_t>(region), &stats);
+        Serial.printf("%-9s %7u bytes in %u blocks (%u in PSRAM), peak %u, failed %u\n",
+                      memory_region_name(static_cast<memory_region_t>(region)),
+                      (unsigned)stats.used, (unsigned)stats.allocations, (unsigned)stats.external,
+                      (unsigned)stats.peak, (unsigned)stats.failures);
+    }
+}
+
+// Smallest bucket limit that covers the given share of a profile's calls, capped at the slowest call
+static uint32_t latencyPercentile(const I2CCommandProfile& profile, uint32_t percent) {
+    uint64_t target = (static_cast<uint64_t>(profile.count) * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (uint8_t bucket = 0; bucket < I2C_PROFILER_BUCKETS; bucket++) {
+        seen += profile.buckets[bucket];
+        if (seen >= target) {
+            return std::min(i2c_profiler_bucket_limit(bucket), profile.maxUs);
+        }
+    }
+    return profile.maxUs;
+}
+
+static void printI2CProfile(uint8_t sensorId) {
+    const I2CBus& bus = I2CScanTask::getInstance(sensorId).getBus();
+    const I2CBusStats& busStats = bus.stats();
+    Serial.printf("Sensor %u bus %u Hz, %u errors, %u clock step downs, %u step ups, %u recoveries\n",
+                  (unsigned)sensorId, (unsigned)bus.clock(), (unsigned)busStats.errors, (unsigned)busStats.stepDowns,
+                  (unsigned)busStats.stepUps, (unsigned)busStats.recoveries);
+    Serial.println("Command               Calls  Errors   Avg us   Max us   p50 <=   p99 <=");
+
+    for (uint8_t command = 0; command < I2C_COMMAND_COUNT; command++) {
+        I2CCommandProfile profile;
+        i2c_profiler_get(sensorId, static_cast<I2CCommand>(command), &profile);
+        if (profile.count == 0) {
+            continue;
+        }
+        Serial.printf("%-20s %7u %7u %8u %8u %8u %8u\n", i2c_command_name(static_cast<I2CCommand>(command)),
+                      (unsigned)profile.count, (unsigned)profile.errors,
+                      (unsigned)(profile.totalUs / profile.count), (unsigned)profile.maxUs,
+                      (unsigned)latencyPercentile(profile, 50), (unsigned)latencyPercentile(profile, 99));
+
+        // Histogram, only the buckets that were hit
+        char line[256];
+        int length = snprintf(line, sizeof(line), "  ");
+        for (uint8_t bucket = 0; bucket < I2C_PROFILER_BUCKETS && length < (int)sizeof(line); bucket++) {
+            if (profile.buckets[bucket] == 0) {
+                continue;
+            }
+            uint32_t limit = i2c_profiler_bucket_limit(bucket);
+            if (limit == UINT32_MAX) {
+                length += snprintf(line + length, sizeof(line) - length, " >=%uus:%u",
+                                   (unsigned)i2c_profiler_bucket_limit(bucket - 1), (unsigned)profile.buckets[bucket]);
+            } else {
+                length += snprintf(line + length, sizeof(line) - length, " <%uus:%u",
+                                   (unsigned)limit, (unsigned)profile.buckets[bucket]);
+            }
+        }
+        Serial.println(line);
+    }
+}
+
+static void handleCommand(const char* command) {
+    if (strcmp(command, "mode text") == 0) {
+        setLogMode(LogMode::Text);
+    } else if (strcmp(command, "mode bin") == 0) {
+        setLogMode(LogMode::Binary);
+    } else if (strcmp(command, "dump") == 0) {
+        dumpHistory();
+    } else if (strcmp(command, "stats") == 0) {
+        printStats();
+    } else if (strcmp(command, "mem") == 0) {
+        printMemory();
+    } else if (strcmp(command, "i2c") == 0) {
+        for (uint8_t sensorId = 0; sensorId < SENSOR_COUNT; sensorId++) {
+            printI2CProfile(sensorId);
+        }
+    } else if (strcmp(command, "i2c reset") == 0) {
+        i2c_profiler_reset();
+    } else if (command[0] != '\0') {
+        Serial.printf("Unknown command: %s (mode text|mode bin|dump|stats|mem|i2c|i2c reset)\n", command);
+    }
+}
+
+static void readCommands() {
+    while (Serial.available() > 0) {
+        int c = Serial.read();
+        if (c == '\n' || c == '\r') {
+            commandLine[commandLength] = '\0';
+            handleCommand(commandLine);
+            commandLength = 0;
+            if (logMode == LogMode::Binary) {
+                // Terminate any text reply so the decoder resynchronizes on the next frame
+                Serial.write(static_cast<uint8_t>(0x00));
+            }
+        } else if (commandLength < SERIAL_COMMAND_MAX_LENGTH - 1) {
+            commandLine[commandLength++] = static_cast<char>(c);
+        }
+    }
+}
 
 void serialLoggingTask(void* parameter) {
     // Subscribe to LiveDataManager
-    if (!LiveDataManager::getInstance().subscribe(xTaskGetCurrentTaskHandle(), &xDataQueue)) {
+    auto& liveData = LiveDataManager::getInstance();
+    if (!liveData.subscribe(xTaskGetCurrentTaskHandle())) {
         Serial.println("Failed to subscribe to LiveDataManager!");
         vTaskDelete(NULL);
         return;
     }
-    
+
+    #if ARDUINO_USB_MODE && ARDUINO_USB_CDC_ON_BOOT
+    // Wake up on serial input, otherwise commands are picked up with the next sample
+    Serial.onEvent(ARDUINO_HW_CDC_RX_EVENT, onSerialReceive);
+    #endif
+
+    setLogMode(LogMode::Text);
+
+    #ifdef DEBUG_MODE
+    TaskWakeupCounter wakeupCounter = {"SerialLogTask", 0, millis()};
+    #endif
+
     QueueMessage message;
+    uint32_t lastSequence = liveData.latestSequence();
     while (true) {
-        // Wait for new data
-        if (xQueueReceive(xDataQueue, &message, pdMS_TO_TICKS(QUEUE_TIMEOUT_MS)) == pdTRUE) {
-            const SensorData& data = message.data;
-            
-            // Print labels
-            Serial.println("PM1.0\tPM2.5\tPM4.0\tPM10.0\tRH\tT\tVOC\tNOx\tCO2\tRaw RH\tRaw T\tRaw VOC\tRaw NOx\tRaw CO2");
-            
-            // Print all values in one line
-            Serial.print(data.pm1p0); Serial.print("\t");
-            Serial.print(data.pm2p5); Serial.print("\t");
-            Serial.print(data.pm4p0); Serial.print("\t");
-            Serial.print(data.pm10p0); Serial.print("\t");
-            Serial.print(data.humidity); Serial.print("\t");
-            Serial.print(data.temperature); Serial.print("\t");
-            Serial.print((int)data.vocIndex); Serial.print("\t");
-            Serial.print((int)data.noxIndex); Serial.print("\t");
-            Serial.print((int)data.co2); Serial.print("\t");
-            Serial.print(data.rawHumidity / 100.0f); Serial.print("\t");
-            Serial.print(data.rawTemperature / 200.0f); Serial.print("\t");
-            Serial.print((int)data.rawVOC); Serial.print("\t");
-            Serial.print((int)data.rawNOx); Serial.print("\t");
-            Serial.println((int)data.rawCO2);
+        // Sleep until a sample is published or a command arrives
+        uint32_t notifiedBits = 0;
+        xTaskNotifyWait(0, LIVE_DATA_NOTIFY_BIT | SERIAL_COMMAND_NOTIFY_BIT, &notifiedBits, portMAX_DELAY);
+
+        #ifdef DEBUG_MODE
+        countTaskWakeup(wakeupCounter);
+        #endif
+
+        readCommands();
+
+        // Log every sample we have not seen yet
+        while (liveData.readNext(lastSequence, message)) {
+            // The text columns carry no sensor ID, only the first sensor is logged and counted
+            if (logMode == LogMode::Text && message.data.sensorId != 0) {
+                continue;
+            }
+            int64_t start = esp_timer_get_time();
+            if (logMode == LogMode::Text) {
+                logText(message.data);
+            } else {
+                logBinary(message);
+            }
+            logStats.cpuUs += esp_timer_get_time() - start;
+            logStats.samples++;
         }
-        
-        // Small delay to prevent task starvation
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
-} 
\ No newline at end of file
+}
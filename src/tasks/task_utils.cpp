@@ -32,4 +32,18 @@ BaseType_t launchTaskWithVerification(
     }
 
     return pdPASS;
-} 
\ No newline at end of file
+}
+
+#ifdef DEBUG_MODE
+void countTaskWakeup(TaskWakeupCounter& counter) {
+    counter.wakeups++;
+
+    uint32_t now = millis();
+    uint32_t elapsed = now - counter.windowStart;
+    if (elapsed >= WAKEUP_REPORT_INTERVAL_MS) {
+        Serial.printf("%s: %.1f wakeups/s\n", counter.name, counter.wakeups * 1000.0f / elapsed);
+        counter.wakeups = 0;
+        counter.windowStart = now;
+    }
+}
+#endif
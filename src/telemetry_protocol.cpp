@@ -0,0 +1,40 @@
+#include "telemetry_protocol.h"
+#include "checksum.h"
+
+size_t telemetry_encode_frame(const uint8_t* payload, size_t length, uint8_t* frame) {
+    if (length > TELEMETRY_MAX_PAYLOAD) {
+        return 0;
+    }
+
+    // Payload followed by its CRC, which is COBS encoded together with it
+    uint8_t raw[TELEMETRY_MAX_PAYLOAD + 2];
+    for (size_t i = 0; i < length; i++) {
+        raw[i] = payload[i];
+    }
+    uint16_t crc = crc16_ccitt(payload, length);
+    raw[length] = crc & 0xFF;
+    raw[length + 1] = crc >> 8;
+    length += 2;
+
+    // COBS: every zero is replaced by the distance to the next zero, so 0x00 only delimits frames
+    size_t out = 1;
+    size_t code_index = 0;
+    uint8_t code = 1;
+    for (size_t i = 0; i < length; i++) {
+        if (raw[i] == 0) {
+            frame[code_index] = code;
+            code_index = out++;
+            code = 1;
+        } else {
+            frame[out++] = raw[i];
+            if (++code == 0xFF) {
+                frame[code_index] = code;
+                code_index = out++;
+                code = 1;
+            }
+        }
+    }
+    frame[code_index] = code;
+    frame[out++] = 0x00;
+    return out;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+// Minimal LVGL 8.3 stand-in for the native test env: only what the generated UI headers and the
+// theme manager use. Objects record their event callbacks and style writes, the heap counts calls.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int16_t lv_coord_t;
+typedef uint32_t lv_style_selector_t;
+typedef uint16_t lv_style_prop_t;
+typedef int lv_scr_load_anim_t;
+typedef struct { uint32_t full; } lv_color_t;
+typedef union { int32_t num; const void* ptr; lv_color_t color; } lv_style_value_t;
+typedef struct { uint32_t header; uint32_t data_size; const uint8_t* data; } lv_img_dsc_t;
+typedef struct _lv_anim_t lv_anim_t;
+typedef struct _lv_event_t lv_event_t;
+typedef void (*lv_event_cb_t)(lv_event_t*);
+typedef struct { uint8_t line_height; } lv_font_t;
+
+#define LV_IMG_DECLARE(var_name)  extern const lv_img_dsc_t var_name
+#define LV_FONT_DECLARE(font_name) extern const lv_font_t font_name
+
+#define LV_STUB_MAX_EVENT_CBS 8
+
+typedef struct _lv_obj_t {
+    lv_event_cb_t delete_cbs[LV_STUB_MAX_EVENT_CBS];
+    uint32_t delete_cb_count;
+    uint32_t style_writes;
+    lv_style_prop_t last_property;
+    lv_style_value_t last_value;
+    bool valid;
+} lv_obj_t;
+
+struct _lv_event_t {
+    lv_obj_t* target;
+};
+
+#define LV_PART_MAIN     0x000000
+#define LV_STATE_DEFAULT 0x0000
+#define LV_STATE_CHECKED 0x0001
+#define LV_EVENT_DELETE  33
+
+enum {
+    LV_STYLE_BG_COLOR = 1, LV_STYLE_BG_GRAD_COLOR, LV_STYLE_BG_IMG_RECOLOR, LV_STYLE_BORDER_COLOR,
+    LV_STYLE_OUTLINE_COLOR, LV_STYLE_SHADOW_COLOR, LV_STYLE_IMG_RECOLOR, LV_STYLE_LINE_COLOR,
+    LV_STYLE_ARC_COLOR, LV_STYLE_TEXT_COLOR, LV_STYLE_BG_GRAD, LV_STYLE_BG_IMG_SRC, LV_STYLE_ARC_IMG_SRC,
+    LV_STYLE_TEXT_FONT, LV_STYLE_COLOR_FILTER_DSC, LV_STYLE_ANIM, LV_STYLE_TRANSITION, LV_STYLE_BG_OPA
+};
+
+#define LV_LOG_WARN(...) ((void) 0)
+
+// Heap calls made through LVGL, the theme manager must not make any
+struct lv_stub_heap_counters {
+    uint32_t allocs;
+    uint32_t reallocs;
+    uint32_t frees;
+};
+inline lv_stub_heap_counters lv_stub_heap = {0, 0, 0};
+
+inline void* lv_mem_alloc(size_t size) { lv_stub_heap.allocs++; return malloc(size); }
+inline void* lv_mem_realloc(void* p, size_t size) { lv_stub_heap.reallocs++; return realloc(p, size); }
+inline void lv_mem_free(void* p) { lv_stub_heap.frees++; free(p); }
+
+inline lv_color_t lv_color_hex(uint32_t c) { lv_color_t color = {c}; return color; }
+
+inline bool lv_obj_is_valid(const lv_obj_t* obj) { return obj->valid; }
+
+inline void lv_obj_set_local_style_prop(lv_obj_t* obj, lv_style_prop_t prop, lv_style_value_t value,
+                                        lv_style_selector_t selector) {
+    (void) selector;
+    obj->style_writes++;
+    obj->last_property = prop;
+    obj->last_value = value;
+}
+
+inline void lv_obj_add_event_cb(lv_obj_t* obj, lv_event_cb_t cb, int filter, void* user_data) {
+    (void) user_data;
+    if (filter == LV_EVENT_DELETE && obj->delete_cb_count < LV_STUB_MAX_EVENT_CBS) {
+        obj->delete_cbs[obj->delete_cb_count] = cb;
+    }
+    obj->delete_cb_count++;
+}
+
+inline lv_obj_t* lv_event_get_target(lv_event_t* e) { return e->target; }
+
+// lv_obj_del: send LV_EVENT_DELETE to the callbacks and invalidate the object
+inline void lv_stub_obj_delete(lv_obj_t* obj) {
+    lv_event_t event = {obj};
+    for (uint32_t i = 0; i < obj->delete_cb_count && i < LV_STUB_MAX_EVENT_CBS; i++) {
+        obj->delete_cbs[i](&event);
+    }
+    obj->valid = false;
+}
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
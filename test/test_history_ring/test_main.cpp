@@ -0,0 +1,171 @@
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "history_ring.h"
+
+#define RING_SIZE 150               // DisplayTask::kRingBufferSize
+#define POINT_NONE INT16_MAX        // LV_CHART_POINT_NONE
+#define BENCHMARK_APPENDS 1000000
+
+using Ring = HistoryRing<int16_t, RING_SIZE, POINT_NONE>;
+
+// Former append path: shift the window left by one and write the newest point at the end
+static void shift_append(int16_t* buffer, int16_t point) {
+    for (size_t i = 0; i < RING_SIZE - 1; i++) {
+        buffer[i] = buffer[i + 1];
+    }
+    buffer[RING_SIZE - 1] = point;
+}
+
+// Former autoscale path: rescan the window for every chart update
+static bool scan_range(const int16_t* buffer, int16_t& min_point, int16_t& max_point) {
+    bool found = false;
+    for (size_t i = 0; i < RING_SIZE; i++) {
+        if (buffer[i] == POINT_NONE) {
+            continue;
+        }
+        if (!found || buffer[i] < min_point) {
+            min_point = buffer[i];
+        }
+        if (!found || buffer[i] > max_point) {
+            max_point = buffer[i];
+        }
+        found = true;
+    }
+    return found;
+}
+
+// Sensor-like input: a random walk with occasional gaps
+static int16_t next_point(uint32_t& state, int16_t& level) {
+    state = state * 1664525u + 1013904223u;
+    if ((state >> 24) < 8) {
+        return POINT_NONE;
+    }
+    level += static_cast<int16_t>((state >> 16) % 21) - 10;
+    return level;
+}
+
+static Ring ring;
+static int16_t shifted[RING_SIZE];
+
+void setUp(void) {
+    ring.clear();
+    for (int16_t& point : shifted) {
+        point = POINT_NONE;
+    }
+}
+
+void tearDown(void) {}
+
+void test_empty_ring_has_no_range(void) {
+    int16_t min_point = 0;
+    int16_t max_point = 0;
+    TEST_ASSERT_FALSE(ring.range(min_point, max_point));
+    TEST_ASSERT_EQUAL(POINT_NONE, ring.last());
+
+    ring.push(POINT_NONE, POINT_NONE, POINT_NONE);
+    TEST_ASSERT_FALSE(ring.range(min_point, max_point));
+}
+
+// The ring read from head must equal the shifted buffer, and its O(1) range the full rescan
+void test_matches_shifting_buffer(void) {
+    uint32_t state = 1;
+    int16_t level = 500;
+    for (uint32_t n = 0; n < 20 * RING_SIZE; n++) {
+        int16_t point = next_point(state, level);
+        ring.push(point, point, point);
+        shift_append(shifted, point);
+
+        for (size_t i = 0; i < RING_SIZE; i++) {
+            if (ring.points[(ring.head + i) % RING_SIZE] != shifted[i]) {
+                TEST_ASSERT_EQUAL(shifted[i], ring.points[(ring.head + i) % RING_SIZE]);
+            }
+        }
+        TEST_ASSERT_EQUAL(point, ring.last());
+
+        int16_t expected_min = 0, expected_max = 0, min_point = 0, max_point = 0;
+        bool expected = scan_range(shifted, expected_min, expected_max);
+        TEST_ASSERT_EQUAL(expected, ring.range(min_point, max_point));
+        if (expected) {
+            TEST_ASSERT_EQUAL(expected_min, min_point);
+            TEST_ASSERT_EQUAL(expected_max, max_point);
+        }
+    }
+}
+
+// Aggregated levels keep the min/max of the samples behind each point, not of the means
+void test_range_uses_point_extremes(void) {
+    ring.push(100, 90, 130);
+    ring.push(POINT_NONE, -500, 500);   // Extremes of a gap are ignored
+    ring.push(105, 80, 110);
+
+    int16_t min_point = 0;
+    int16_t max_point = 0;
+    TEST_ASSERT_TRUE(ring.range(min_point, max_point));
+    TEST_ASSERT_EQUAL(80, min_point);
+    TEST_ASSERT_EQUAL(130, max_point);
+
+    // Once the extremes leave the window the range follows the remaining points
+    for (size_t i = 0; i < RING_SIZE - 1; i++) {
+        ring.push(100, 100, 100);
+    }
+    TEST_ASSERT_TRUE(ring.range(min_point, max_point));
+    TEST_ASSERT_EQUAL(80, min_point);
+    TEST_ASSERT_EQUAL(110, max_point);
+    ring.push(100, 100, 100);
+    TEST_ASSERT_TRUE(ring.range(min_point, max_point));
+    TEST_ASSERT_EQUAL(100, min_point);
+    TEST_ASSERT_EQUAL(100, max_point);
+}
+
+// Per sample the display task appends a point and autoscales the chart from the window range
+void test_benchmark_append(void) {
+    uint32_t state = 7;
+    int16_t level = 500;
+    int32_t checksum = 0;
+    int16_t min_point = 0;
+    int16_t max_point = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t n = 0; n < BENCHMARK_APPENDS; n++) {
+        int16_t point = next_point(state, level);
+        shift_append(shifted, point);
+        if (scan_range(shifted, min_point, max_point)) {
+            checksum += min_point + max_point;
+        }
+    }
+    auto shift_time = std::chrono::steady_clock::now() - start;
+
+    state = 7;
+    level = 500;
+    int32_t ring_checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t n = 0; n < BENCHMARK_APPENDS; n++) {
+        int16_t point = next_point(state, level);
+        ring.push(point, point, point);
+        if (ring.range(min_point, max_point)) {
+            ring_checksum += min_point + max_point;
+        }
+    }
+    auto ring_time = std::chrono::steady_clock::now() - start;
+
+    // Both paths must have seen the same ranges, which also keeps the loops from being optimized away
+    TEST_ASSERT_EQUAL(checksum, ring_checksum);
+
+    char message[128];
+    snprintf(message, sizeof(message), "append + range, ns per sample: shifting buffer %.1f, circular buffer %.1f",
+             std::chrono::duration<double, std::nano>(shift_time).count() / BENCHMARK_APPENDS,
+             std::chrono::duration<double, std::nano>(ring_time).count() / BENCHMARK_APPENDS);
+    TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_ring_has_no_range);
+    RUN_TEST(test_matches_shifting_buffer);
+    RUN_TEST(test_range_uses_point_extremes);
+    RUN_TEST(test_benchmark_append);
+    return UNITY_END();
+}
@@ -0,0 +1,103 @@
+#include <unity.h>
+#include <stdio.h>
+
+#include "parameter_descriptors.h"
+
+// Chart point of the former float path: sensor integer to display units, then times 10^decimals
+static int32_t float_point(const ParameterDescriptor& descriptor, int32_t value) {
+    float display = value / descriptor.sensorScale;
+    return static_cast<int32_t>(display * descriptor.scale);
+}
+
+// value * 10^decimals / sensorScale, truncated toward zero, without any float arithmetic
+static int32_t exact_point(const ParameterDescriptor& descriptor, int32_t value) {
+    int64_t numerator = value;
+    for (uint8_t i = 0; i < descriptor.decimals; i++) {
+        numerator *= 10;
+    }
+    return static_cast<int32_t>(numerator / static_cast<int64_t>(descriptor.sensorScale));
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_scale_factors(void) {
+    for (size_t i = 0; i < PARAMETER_CHANNEL_COUNT; i++) {
+        const ParameterDescriptor& descriptor = kParameterDescriptors[i];
+        TEST_ASSERT_TRUE(descriptor.pointMultiplier == 1 || descriptor.pointDivisor == 1);
+        TEST_ASSERT_EQUAL(static_cast<int32_t>(descriptor.scale) * descriptor.pointDivisor,
+                          static_cast<int32_t>(descriptor.sensorScale) * descriptor.pointMultiplier);
+    }
+}
+
+// Every sensor integer in the valid range maps to the exact rational result, and to the
+// former float result except where the float path itself drifted by one point
+void test_integer_matches_float_path(void) {
+    for (size_t i = 0; i < PARAMETER_CHANNEL_COUNT; i++) {
+        const ParameterDescriptor& descriptor = kParameterDescriptors[i];
+        uint32_t float_drift = 0;
+        for (int32_t value = descriptor.sensorMin; value <= descriptor.sensorMax; value++) {
+            int32_t point = parameter_sensor_to_point(descriptor, value);
+            TEST_ASSERT_EQUAL_INT_MESSAGE(exact_point(descriptor, value), point, descriptor.name);
+            int32_t legacy = float_point(descriptor, value);
+            TEST_ASSERT_INT_WITHIN_MESSAGE(1, legacy, point, descriptor.name);
+            if (legacy != point) {
+                float_drift++;
+            }
+        }
+        // PM, CO2, VOC and NOx carry at most one decimal, which float reproduces exactly
+        if (descriptor.sensorScale <= 10.0f) {
+            TEST_ASSERT_EQUAL_MESSAGE(0, float_drift, descriptor.name);
+        }
+        char message[96];
+        snprintf(message, sizeof(message), "%s: %u of %ld values differ from the float path by one point",
+                 descriptor.name, static_cast<unsigned>(float_drift),
+                 static_cast<long>(descriptor.sensorMax - descriptor.sensorMin + 1));
+        TEST_MESSAGE(message);
+    }
+}
+
+void test_sensor_range_matches_display_range(void) {
+    for (size_t i = 0; i < PARAMETER_CHANNEL_COUNT; i++) {
+        const ParameterDescriptor& descriptor = kParameterDescriptors[i];
+        for (int32_t value = descriptor.sensorMin - 100; value <= descriptor.sensorMax + 100; value++) {
+            TEST_ASSERT_EQUAL_MESSAGE(parameter_is_valid(descriptor, value / descriptor.sensorScale),
+                                      parameter_sensor_is_valid(descriptor, value), descriptor.name);
+        }
+    }
+}
+
+void test_negative_values_truncate_toward_zero(void) {
+    const ParameterDescriptor& temperature = parameter_descriptor(ParameterChannel::Temperature);
+    TEST_ASSERT_EQUAL(-1, parameter_sensor_to_point(temperature, -3));   // -0.015 °C
+    TEST_ASSERT_EQUAL(0, parameter_sensor_to_point(temperature, -1));    // -0.005 °C
+    TEST_ASSERT_EQUAL(-4000, parameter_sensor_to_point(temperature, -8000));
+}
+
+void test_sensor_mean_rounds_to_nearest(void) {
+    TEST_ASSERT_EQUAL(401, parameter_sensor_mean(400 + 401, 2));    // CO2 400 and 401 ppm
+    TEST_ASSERT_EQUAL(400, parameter_sensor_mean(400 + 400 + 401, 3));
+    TEST_ASSERT_EQUAL(-401, parameter_sensor_mean(-400 - 401, 2));  // Halves away from zero on both sides
+    TEST_ASSERT_EQUAL(-400, parameter_sensor_mean(-400 - 400 - 401, 3));
+    TEST_ASSERT_EQUAL(0, parameter_sensor_mean(-1 + 1, 2));
+    TEST_ASSERT_EQUAL(-1, parameter_sensor_mean(-2 + 1, 2));
+
+    // Against the rounded exact mean over a range of pairs, negative temperatures included
+    for (int32_t a = -300; a <= 300; a++) {
+        for (int32_t b = a - 3; b <= a + 3; b++) {
+            double exact = (a + b) / 2.0;
+            int32_t expected = static_cast<int32_t>(exact >= 0 ? exact + 0.5 : exact - 0.5);
+            TEST_ASSERT_EQUAL(expected, parameter_sensor_mean(a + b, 2));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_scale_factors);
+    RUN_TEST(test_integer_matches_float_path);
+    RUN_TEST(test_sensor_range_matches_display_range);
+    RUN_TEST(test_negative_values_truncate_toward_zero);
+    RUN_TEST(test_sensor_mean_rounds_to_nearest);
+    return UNITY_END();
+}
@@ -0,0 +1,125 @@
+#include <unity.h>
+#include <string.h>
+
+#include "checksum.h"
+#include "telemetry_protocol.h"
+
+// Reference COBS decoder as a host would implement it, returns the decoded length or 0 on a malformed frame
+static size_t cobs_decode(const uint8_t* frame, size_t length, uint8_t* out) {
+    if (length == 0 || frame[length - 1] != 0x00) {
+        return 0;
+    }
+    length--;  // Drop the delimiter
+
+    size_t in = 0;
+    size_t decoded = 0;
+    while (in < length) {
+        uint8_t code = frame[in++];
+        if (code == 0) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            if (in >= length) {
+                return 0;
+            }
+            out[decoded++] = frame[in++];
+        }
+        if (code != 0xFF && in < length) {
+            out[decoded++] = 0x00;
+        }
+    }
+    return decoded;
+}
+
+// Encode, check the framing invariants, decode and compare payload and CRC
+static void check_round_trip(const uint8_t* payload, size_t length) {
+    uint8_t frame[TELEMETRY_MAX_FRAME];
+    size_t frame_length = telemetry_encode_frame(payload, length, frame);
+    TEST_ASSERT_GREATER_THAN(0, frame_length);
+    TEST_ASSERT_LESS_OR_EQUAL(TELEMETRY_MAX_FRAME, frame_length);
+    TEST_ASSERT_EQUAL_HEX8(0x00, frame[frame_length - 1]);
+    for (size_t i = 0; i < frame_length - 1; i++) {
+        TEST_ASSERT_NOT_EQUAL(0x00, frame[i]);
+    }
+
+    uint8_t decoded[TELEMETRY_MAX_FRAME];
+    size_t decoded_length = cobs_decode(frame, frame_length, decoded);
+    TEST_ASSERT_EQUAL(length + 2, decoded_length);
+    if (length > 0) {
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, decoded, length);
+    }
+    uint16_t crc = decoded[length] | (decoded[length + 1] << 8);
+    TEST_ASSERT_EQUAL_HEX16(crc16_ccitt(payload, length), crc);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_crc_check_values(void) {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16_ccitt(check, sizeof(check)));
+
+    // Chained calls equal one call over the whole buffer
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16_ccitt(check + 4, 5, crc16_ccitt(check, 4)));
+
+    // Example from the SEN66 datasheet
+    const uint8_t word[] = {0xBE, 0xEF};
+    TEST_ASSERT_EQUAL_HEX8(0x92, crc8_sensirion(word, sizeof(word)));
+}
+
+void test_round_trip_every_length(void) {
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+    for (size_t length = 0; length <= TELEMETRY_MAX_PAYLOAD; length++) {
+        check_round_trip(payload, length);
+    }
+}
+
+void test_round_trip_zero_runs(void) {
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD];
+    memset(payload, 0x00, sizeof(payload));
+    for (size_t length = 0; length <= TELEMETRY_MAX_PAYLOAD; length++) {
+        check_round_trip(payload, length);
+    }
+
+    memset(payload, 0xFF, sizeof(payload));
+    for (size_t length = 0; length <= TELEMETRY_MAX_PAYLOAD; length++) {
+        check_round_trip(payload, length);
+    }
+
+    // Alternating zero and non-zero bytes, the worst case for block codes
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (i & 1) ? 0x00 : 0x5A;
+    }
+    check_round_trip(payload, sizeof(payload));
+}
+
+void test_round_trip_sample(void) {
+    TelemetrySample sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.header.version = TELEMETRY_PROTOCOL_VERSION;
+    sample.header.type = static_cast<uint8_t>(TelemetryRecordType::Sample);
+    sample.timestamp = 0x00010000;
+    sample.pm2p5 = 125;
+    sample.temperature = -200;
+    sample.co2 = 0xFFFF;
+    check_round_trip(reinterpret_cast<const uint8_t*>(&sample), sizeof(sample));
+}
+
+void test_oversize_payload_rejected(void) {
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD + 1] = {};
+    uint8_t frame[TELEMETRY_MAX_FRAME + 1];
+    TEST_ASSERT_EQUAL(0, telemetry_encode_frame(payload, sizeof(payload), frame));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc_check_values);
+    RUN_TEST(test_round_trip_every_length);
+    RUN_TEST(test_round_trip_zero_runs);
+    RUN_TEST(test_round_trip_sample);
+    RUN_TEST(test_oversize_payload_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,130 @@
+#include <unity.h>
+#include <string.h>
+
+#include "ui/ui.h"
+
+#define LABEL_COUNT 9          // Value labels updated on every sensor sample
+#define UPDATE_CYCLES 100000
+
+static lv_obj_t labels[LABEL_COUNT];
+
+void setUp(void) {
+    // Objects left registered by the previous test are deleted, which empties the registry
+    for (lv_obj_t& label : labels) {
+        if (label.valid) {
+            lv_stub_obj_delete(&label);
+        }
+        memset(&label, 0, sizeof(label));
+        label.valid = true;
+    }
+    lv_stub_heap = {0, 0, 0};
+    ui_theme_idx = UI_THEME_DEFAULT;
+}
+
+void tearDown(void) {}
+
+// The display task recolours every value label on every sample: the registry must not grow
+// and the theme manager must not touch the heap, however long the device runs
+void test_color_updates_keep_registry_bounded(void) {
+    for (uint32_t cycle = 0; cycle < UPDATE_CYCLES; cycle++) {
+        const ui_theme_variable_t* color = (cycle & 1) ? _ui_theme_color_Orange : _ui_theme_color_Green;
+        for (lv_obj_t& label : labels) {
+            ui_object_set_themeable_style_property(&label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR, color);
+        }
+        if (ui_theme_style_setting_count() != LABEL_COUNT) {
+            TEST_ASSERT_EQUAL_MESSAGE(LABEL_COUNT, ui_theme_style_setting_count(), "registry grew");
+        }
+    }
+
+    TEST_ASSERT_EQUAL(0, lv_stub_heap.allocs);
+    TEST_ASSERT_EQUAL(0, lv_stub_heap.reallocs);
+    TEST_ASSERT_EQUAL(0, lv_stub_heap.frees);
+    for (const lv_obj_t& label : labels) {
+        TEST_ASSERT_EQUAL(1, label.delete_cb_count);
+        TEST_ASSERT_EQUAL(UPDATE_CYCLES, label.style_writes);
+        TEST_ASSERT_EQUAL(LV_STYLE_TEXT_COLOR, label.last_property);
+        TEST_ASSERT_EQUAL(_ui_theme_color_Orange[0], label.last_value.color.full);
+    }
+}
+
+// A theme change re-applies each registered property once, with the variable it was last set to
+void test_theme_change_applies_each_setting_once(void) {
+    for (uint32_t cycle = 0; cycle < 10; cycle++) {
+        for (lv_obj_t& label : labels) {
+            ui_object_set_themeable_style_property(&label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR,
+                                                   (cycle & 1) ? _ui_theme_color_Red : _ui_theme_color_Blue);
+        }
+    }
+    // A second property of the same object is a separate setting but shares the delete callback
+    ui_object_set_themeable_style_property(&labels[0], LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_BG_COLOR,
+                                           _ui_theme_color_Green);
+    TEST_ASSERT_EQUAL(LABEL_COUNT + 1, ui_theme_style_setting_count());
+    TEST_ASSERT_EQUAL(1, labels[0].delete_cb_count);
+
+    for (lv_obj_t& label : labels) {
+        label.style_writes = 0;
+    }
+    _ui_theme_set_variable_styles(UI_VARIABLE_STYLES_MODE_INIT);
+    TEST_ASSERT_EQUAL(2, labels[0].style_writes);
+    for (uint32_t i = 1; i < LABEL_COUNT; i++) {
+        TEST_ASSERT_EQUAL(1, labels[i].style_writes);
+        TEST_ASSERT_EQUAL(_ui_theme_color_Red[0], labels[i].last_value.color.full);
+    }
+
+    // Nothing changed since: following the theme writes nothing
+    _ui_theme_set_variable_styles(UI_VARIABLE_STYLES_MODE_FOLLOW);
+    TEST_ASSERT_EQUAL(1, labels[1].style_writes);
+}
+
+// Deleting an object drops all of its settings, the others stay reachable
+void test_delete_drops_object_settings(void) {
+    for (lv_obj_t& label : labels) {
+        ui_object_set_themeable_style_property(&label, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR,
+                                               _ui_theme_color_Green);
+    }
+    ui_object_set_themeable_style_property(&labels[3], LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_BG_COLOR,
+                                           _ui_theme_color_Green);
+    TEST_ASSERT_EQUAL(LABEL_COUNT + 1, ui_theme_style_setting_count());
+
+    lv_stub_obj_delete(&labels[3]);
+    TEST_ASSERT_EQUAL(LABEL_COUNT - 1, ui_theme_style_setting_count());
+
+    // Updating the remaining labels after the index rebuild still finds their entries
+    for (uint32_t i = 0; i < LABEL_COUNT; i++) {
+        if (i == 3) {
+            continue;
+        }
+        ui_object_set_themeable_style_property(&labels[i], LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR,
+                                               _ui_theme_color_Orange);
+        TEST_ASSERT_EQUAL(1, labels[i].delete_cb_count);
+    }
+    TEST_ASSERT_EQUAL(LABEL_COUNT - 1, ui_theme_style_setting_count());
+}
+
+// A full registry still sets the property, it only stops following theme changes
+void test_full_registry_still_applies(void) {
+    static lv_obj_t extra[UI_THEME_MAX_STYLE_SETTINGS + 1];
+    for (lv_obj_t& obj : extra) {
+        memset(&obj, 0, sizeof(obj));
+        obj.valid = true;
+        ui_object_set_themeable_style_property(&obj, LV_PART_MAIN | LV_STATE_DEFAULT, LV_STYLE_TEXT_COLOR,
+                                               _ui_theme_color_Green);
+        TEST_ASSERT_EQUAL(1, obj.style_writes);
+    }
+    TEST_ASSERT_EQUAL(UI_THEME_MAX_STYLE_SETTINGS, ui_theme_style_setting_count());
+    TEST_ASSERT_EQUAL(0, extra[UI_THEME_MAX_STYLE_SETTINGS].delete_cb_count);
+
+    for (lv_obj_t& obj : extra) {
+        lv_stub_obj_delete(&obj);
+    }
+    TEST_ASSERT_EQUAL(0, ui_theme_style_setting_count());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_color_updates_keep_registry_bounded);
+    RUN_TEST(test_theme_change_applies_each_setting_once);
+    RUN_TEST(test_delete_drops_object_settings);
+    RUN_TEST(test_full_registry_still_applies);
+    return UNITY_END();
+}